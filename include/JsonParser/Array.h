@@ -0,0 +1,242 @@
+#pragma once
+#include <stdint.h>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <memory>
+#include <memory_resource>
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace Json
+{
+	// Contiguous sequence with the std::vector interface Value arrays need
+	// Allocates from a std::pmr::memory_resource, or the global heap when it has none, and still fits in
+	// 24 bytes by keeping size and capacity in 32 bits; a std::vector with a stateful allocator is 32 bytes,
+	// which measurably slows down building documents made of many small arrays
+	// Copies allocate from the heap, like copies of containers using std::pmr::polymorphic_allocator
+	template<typename T>
+	class BasicArray
+	{
+	public:
+		using value_type = T;
+		using size_type = size_t;
+		using difference_type = ptrdiff_t;
+		using reference = T&;
+		using const_reference = const T&;
+		using pointer = T*;
+		using const_pointer = const T*;
+		using iterator = T*;
+		using const_iterator = const T*;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	private:
+		T* m_data = nullptr;
+		uint32_t m_size = 0;
+		uint32_t m_capacity = 0;
+		std::pmr::memory_resource* m_resource = nullptr;
+
+		inline T* allocate(size_t count) {
+			if (!m_resource) return std::allocator<T>().allocate(count);
+			return static_cast<T*>(m_resource->allocate(count * sizeof(T), alignof(T)));
+		}
+
+		inline void deallocate(T* data, size_t count) noexcept {
+			if (!data) return;
+			if (!m_resource) std::allocator<T>().deallocate(data, count);
+			else m_resource->deallocate(data, count * sizeof(T), alignof(T));
+		}
+
+		void reallocate(size_t capacity) {
+			if (capacity > UINT32_MAX) throw std::length_error("Array too large");
+			T* data = allocate(capacity);
+			if constexpr (std::is_trivially_copyable_v<T>) {
+				if (m_size) std::memcpy(data, m_data, m_size * sizeof(T));
+			}
+			else {
+				for (uint32_t i = 0; i < m_size; ++i) {
+					new (data + i) T(std::move(m_data[i]));
+					m_data[i].~T();
+				}
+			}
+			deallocate(m_data, m_capacity);
+			m_data = data;
+			m_capacity = static_cast<uint32_t>(capacity);
+		}
+
+		inline void grow() {
+			reallocate(m_capacity ? size_t(m_capacity) * 2 : 1);
+		}
+
+		template<typename It>
+		void assign(It first, It last) {
+			const size_t count = static_cast<size_t>(std::distance(first, last));
+			if (count == 0) return;
+			if (count > UINT32_MAX) throw std::length_error("Array too large");
+			m_data = allocate(count);
+			m_capacity = static_cast<uint32_t>(count);
+			for (; first != last; ++first) {
+				new (m_data + m_size) T(*first);
+				++m_size;
+			}
+		}
+
+	public:
+		BasicArray() noexcept = default;
+		explicit BasicArray(std::pmr::memory_resource* resource) noexcept : m_resource(resource) {}
+
+		BasicArray(std::initializer_list<T> values, std::pmr::memory_resource* resource = nullptr) : m_resource(resource) {
+			assign(values.begin(), values.end());
+		}
+
+		~BasicArray() {
+			clear();
+			deallocate(m_data, m_capacity);
+		}
+
+		BasicArray(const BasicArray& other) {
+			assign(other.begin(), other.end());
+		}
+
+		BasicArray(BasicArray&& other) noexcept
+			: m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)),
+			m_capacity(std::exchange(other.m_capacity, 0)), m_resource(other.m_resource) {}
+
+		BasicArray& operator=(const BasicArray& other) {
+			if (this != &other) {
+				clear();
+				reserve(other.size());
+				for (const T& value : other) push_back(value);
+			}
+			return *this;
+		}
+
+		// Takes other's buffer when both arrays allocate from the same resource. Otherwise the array keeps its own
+		// resource and the elements are moved into a buffer allocated from it, which can throw like the move
+		// assignment of a std::pmr::vector, and the array is left unchanged if it does
+		BasicArray& operator=(BasicArray&& other) {
+			if (this == &other) return *this;
+			if (m_resource != other.m_resource) {
+				BasicArray moved(m_resource);
+				moved.reserve(other.size());
+				for (T& value : other) moved.push_back(std::move(value));
+				other.clear();
+				return *this = std::move(moved);
+			}
+			clear();
+			deallocate(m_data, m_capacity);
+			m_data = std::exchange(other.m_data, nullptr);
+			m_size = std::exchange(other.m_size, 0);
+			m_capacity = std::exchange(other.m_capacity, 0);
+			return *this;
+		}
+
+		// nullptr for the global heap
+		std::pmr::memory_resource* resource() const noexcept { return m_resource; }
+
+		size_t size() const noexcept { return m_size; }
+		size_t capacity() const noexcept { return m_capacity; }
+		bool empty() const noexcept { return m_size == 0; }
+
+		T* data() noexcept { return m_data; }
+		const T* data() const noexcept { return m_data; }
+
+		iterator begin() noexcept { return m_data; }
+		iterator end() noexcept { return m_data + m_size; }
+		const_iterator begin() const noexcept { return m_data; }
+		const_iterator end() const noexcept { return m_data + m_size; }
+		const_iterator cbegin() const noexcept { return begin(); }
+		const_iterator cend() const noexcept { return end(); }
+		reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+		reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+		const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+		const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+		T& operator[](size_t index) noexcept { return m_data[index]; }
+		const T& operator[](size_t index) const noexcept { return m_data[index]; }
+
+		T& at(size_t index) {
+			if (index >= m_size) throw std::out_of_range("Array index out of range");
+			return m_data[index];
+		}
+		const T& at(size_t index) const {
+			return const_cast<BasicArray*>(this)->at(index);
+		}
+
+		T& front() noexcept { return m_data[0]; }
+		T& back() noexcept { return m_data[m_size - 1]; }
+		const T& front() const noexcept { return m_data[0]; }
+		const T& back() const noexcept { return m_data[m_size - 1]; }
+
+		void reserve(size_t capacity) {
+			if (capacity > m_capacity) reallocate(capacity);
+		}
+
+		template<typename... Args>
+		T& emplace_back(Args&&... args) {
+			if (m_size == m_capacity) {
+				// args may refer to an element, build the new one before the old storage goes away
+				if constexpr (sizeof...(Args) == 1 && (std::is_same_v<std::remove_cvref_t<Args>, T> && ...)) {
+					T value(std::forward<Args>(args)...);
+					grow();
+					new (m_data + m_size) T(std::move(value));
+					return m_data[m_size++];
+				}
+				else grow();
+			}
+			new (m_data + m_size) T(std::forward<Args>(args)...);
+			return m_data[m_size++];
+		}
+
+		void push_back(const T& value) { emplace_back(value); }
+		void push_back(T&& value) { emplace_back(std::move(value)); }
+
+		void pop_back() noexcept {
+			m_data[--m_size].~T();
+		}
+
+		void clear() noexcept {
+			for (uint32_t i = 0; i < m_size; ++i) m_data[i].~T();
+			m_size = 0;
+		}
+
+		void resize(size_t size) {
+			if (size < m_size) {
+				while (m_size > size) pop_back();
+				return;
+			}
+			reserve(size);
+			while (m_size < size) emplace_back();
+		}
+
+		iterator erase(const_iterator position) {
+			T* it = m_data + (position - m_data);
+			std::move(it + 1, end(), it);
+			pop_back();
+			return it;
+		}
+
+		friend bool operator==(const BasicArray& lhs, const BasicArray& rhs) {
+			return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+		}
+		friend bool operator!=(const BasicArray& lhs, const BasicArray& rhs) {
+			return !(lhs == rhs);
+		}
+		friend bool operator<(const BasicArray& lhs, const BasicArray& rhs) {
+			return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+		}
+		friend bool operator>(const BasicArray& lhs, const BasicArray& rhs) {
+			return rhs < lhs;
+		}
+		friend bool operator<=(const BasicArray& lhs, const BasicArray& rhs) {
+			return !(rhs < lhs);
+		}
+		friend bool operator>=(const BasicArray& lhs, const BasicArray& rhs) {
+			return !(lhs < rhs);
+		}
+	};
+}
\ No newline at end of file
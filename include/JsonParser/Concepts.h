@@ -1,4 +1,7 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
 
 namespace Json
 {
@@ -13,4 +16,58 @@ namespace Json
 		t.size();
 		t[0];
 	};
+
+	// Receives parse events in document order, every parser can drive one instead of building a Value
+	// Keys are reported through onKey right before the member's value, string views are only
+	// valid for the duration of the call
+	template<typename T>
+	concept Handler = requires(T & t, std::string_view s, int64_t i, double d, bool b) {
+		t.onNull();
+		t.onBool(b);
+		t.onInt64(i);
+		t.onDouble(d);
+		t.onString(s);
+		t.onKey(s);
+		t.onStartArray();
+		t.onEndArray();
+		t.onStartObject();
+		t.onEndObject();
+	};
+
+	// A Handler that also takes onString(s, escapeFree) and onKey(s, escapeFree), escapeFree telling that the
+	// parser found no character JSON has to escape in the string, which then is a view into the input
+	template<typename T>
+	concept EscapeAwareHandler = Handler<T> && requires(T & t, std::string_view s, bool b) {
+		t.onString(s, b);
+		t.onKey(s, b);
+	};
+
+	// Where Serializer writes, std::string or a ChunkedOutput passing the text on to a Sink
+	template<typename T>
+	concept OutputBuffer = requires(T & t, std::string_view s, size_t n, char c) {
+		t.push_back(c);
+		t.append(s);
+		t.append(n, c);
+	};
+
+	// Takes serialized text a chunk at a time, see ChunkedOutput
+	template<typename T>
+	concept Sink = requires(T & t, const char* data, size_t size) {
+		t.write(data, size);
+	};
+
+	namespace Detail
+	{
+		template<Handler H>
+		inline void reportString(H& handler, std::string_view value, bool escapeFree) {
+			if constexpr (EscapeAwareHandler<H>) handler.onString(value, escapeFree);
+			else handler.onString(value);
+		}
+
+		template<Handler H>
+		inline void reportKey(H& handler, std::string_view key, bool escapeFree) {
+			if constexpr (EscapeAwareHandler<H>) handler.onKey(key, escapeFree);
+			else handler.onKey(key);
+		}
+	}
 }
\ No newline at end of file
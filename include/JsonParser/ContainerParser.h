@@ -4,11 +4,16 @@
 #include <stdexcept>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <algorithm>
 #include <fstream>
 
 #include "JsonParser/Utils/SIMDUtils.h"
+#include "JsonParser/Utils/ScanUtils.h"
+#include "JsonParser/Utils/NumberParsing.h"
+#include "JsonParser/Utils/Escapes.h"
 #include "JsonParser/Concepts.h"
+#include "JsonParser/ValueBuilder.h"
 
 namespace Json
 {
@@ -36,371 +41,71 @@ namespace Json
 		static inline const std::string falseLiteral = "false";
 
 	private:
-		static inline bool isWhitespace(char c) {
-			return c == ' ' || c == '\t' || c == '\r' || c == '\n';
-		}
-
-		template<Container C>
-		static inline void handleEscapedChar(C& input, size_t& i, std::string& string)
-		{
-			if (i >= input.size()) throw std::runtime_error("Unterminated escape sequence");
-			char escaped = input[i];
-			switch (escaped) {
-			case '"':  string.push_back('"'); break;
-			case '\\': string.push_back('\\'); break;
-			case '/':  string.push_back('/'); break;
-			case 'b':  string.push_back('\b'); break;
-			case 'f':  string.push_back('\f'); break;
-			case 'n':  string.push_back('\n'); break;
-			case 'r':  string.push_back('\r'); break;
-			case 't':  string.push_back('\t'); break;
-			case 'u': {
-				// Unicode escape \uXXXX
-				i += 4;
-				if (i >= input.size())
-					throw std::runtime_error("Invalid unicode escape");
-
-				std::string hex;
-				hex.append(&input[i - 3], 4);
-
-				// Convert hex to unicode
-				unsigned int codepoint = std::stoul(hex, nullptr, 16);
-				if (codepoint <= 0x7F) {
-					string.push_back(static_cast<char>(codepoint));
-				}
-				else {
-					// Convert Unicode codepoint to UTF-8
-					if (codepoint <= 0x7FF) {
-						// 2-byte UTF-8
-						string.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
-						string.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
-					}
-					else {
-						// 3-byte UTF-8 (covers BMP)
-						string.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
-						string.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
-						string.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
-					}
-				}
-				break;
-			}
-			default:
-				throw std::runtime_error(std::string("Invalid escape sequence: \\") + escaped);
-			}
-		}
-
-	private:
-
-#ifdef HAS_AVX2
-		template<Container C>
-		static inline size_t skipCommentSIMD32(const C& input, size_t i) {
-
-			//static const __m256i ws_slash = _mm256_set1_epi8('/');
-			static const __m256i ws_star = _mm256_set1_epi8('*');
-			static const __m256i ws_lf = _mm256_set1_epi8('\n');
-			__m256i chunk;
-			uint32_t mask;
-
-			i += 2;
-			if (i >= input.size())
-				throw std::runtime_error("Invalid comment syntax");
-			else if (input[i - 1] == '/')
-			{
-				while (i + 32 <= input.size()) {
-					chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input[i]));
-					mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, ws_lf));
-					if (mask != 0)
-						return i + CTZ32(mask);
-					i += 32;
-				}
-				for (; i < input.size() && input[i] != '\n'; ++i);
-				return i;
-			}
-			else if (input[i - 1] == '*')
-			{
-				while (i + 32 <= input.size()) {
-					chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input[i]));
-					mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, ws_star));
-					if (mask != 0) {
-						size_t j = i + CTZ32(mask) + 1;
-						if (j >= input.size())
-							throw std::runtime_error("Invalid comment syntax");
-						else if (input[j] == '/')
-							return j;
-						i = j + 1;
-						continue;
-					}
-					i += 32;
-				}
-				for (; i < input.size(); ++i)
-				{
-					if (input[i] == '*' && ++i < input.size() && input[i] == '/') {
-						return i;
-					}
-				}
-				throw std::runtime_error("Endless block comment");
-			}
-			throw std::runtime_error(std::string("Invalid comment syntax") + input[i]);
-		};
-#endif
-
-#ifdef HAS_SSE2
-		template<Container C>
-		static inline size_t skipCommentSIMD16(const C& input, size_t i) {
-
-			//static const __m256i ws_slash = _mm256_set1_epi8('/');
-			static const __m128i ws_star = _mm_set1_epi8('*');
-			static const __m128i ws_lf = _mm_set1_epi8('\n');
-			__m128i chunk;
-			uint16_t mask;
-
-			i += 2;
-			if (i >= input.size())
-				throw std::runtime_error("Invalid comment syntax");
-			char c = input[i - 1];
-			if (c == '/')
-			{
-				while (i + 16 <= input.size()) {
-					chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
-					mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, ws_lf));
-					if (mask != 0)
-						return i + CTZ16(mask);
-					i += 16;
-				}
-				for (; i < input.size() && input[i] != '\n'; ++i);
-				return i;
-			}
-			else if (c == '*')
-			{
-				while (i + 16 <= input.size()) {
-					chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
-					mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, ws_star));
-					if (mask != 0) {
-						size_t j = i + CTZ16(mask) + 1;
-						if (j >= input.size())
-							throw std::runtime_error("Invalid comment syntax");
-						else if (input[j] == '/')
-							return j;
-						i = j + 1;
-						continue;
-					}
-					i += 16;
-				}
-				for (; i < input.size(); ++i)
-				{
-					if (input[i] == '*' && ++i < input.size() && input[i] == '/') {
-						return i;
-					}
-				}
-				throw std::runtime_error("Endless block comment");
-			}
-			throw std::runtime_error(std::string("Invalid comment syntax") + input[i]);
-		};
-#endif
-
-		template<Container C>
-		static inline size_t skipCommentScalar(const C& input, size_t i) {
-			++i;
-			if (i >= input.size()) throw std::runtime_error("Invalid comment syntax");
-			char c = input[i];
-			++i;
-			if (c == lineComment) {
-				for (; i < input.size() && input[i] != '\n'; ++i); // skip to end of line
-				return i;
-			}
-			else if (c == blockCommentStart) {
-				for (; i < input.size(); ++i)
-				{
-					if (input[i] == blockCommentEnd && ++i < input.size() && input[i] == commentStart) {
-						return i;
-					}
-				}
-				throw std::runtime_error("Endless block comment");
-			}
-			throw std::runtime_error("Invalid comment syntax");
-		}
-
-
-#ifdef HAS_AVX2
-		template<Container C>
-		static inline size_t skipWhitespaceSIMD32(const C& input, size_t i) {
-			const size_t size = input.size();
-
-			static const __m256i ws_space = _mm256_set1_epi8(' ');
-			static const __m256i ws_tab = _mm256_set1_epi8('\t');
-			static const __m256i ws_cr = _mm256_set1_epi8('\r');
-			static const __m256i ws_lf = _mm256_set1_epi8('\n');
-
-			__m256i chunk;
-			uint32_t mask;
-
-			while (i + 32 <= size) {
-				chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input[i]));
-
-				mask = ~_mm256_movemask_epi8(_mm256_or_si256(
-					_mm256_or_si256(_mm256_cmpeq_epi8(chunk, ws_space), _mm256_cmpeq_epi8(chunk, ws_tab)),
-					_mm256_or_si256(_mm256_cmpeq_epi8(chunk, ws_cr), _mm256_cmpeq_epi8(chunk, ws_lf))));
-
-				if (mask != 0) {
-					size_t j = i + CTZ32(mask);
-					if (input[j] == '/')
-					{
-						i = skipCommentSIMD32(input, j) + 1;
-						continue;
-					}
-					return j;
-				}
-
-				i += 32;
-			}
-
-				for (; i < input.size(); ++i) {
-				char c = input[i];
-				if (isWhitespace(c)) continue;
-				if (c == commentStart) {
-					i = skipCommentScalar(input, i);
-					continue;
-				}
-				return i;
-			}
-			return i;
-		};
-#endif
-
-#ifdef HAS_SSE2
-		template<Container C>
-		static inline size_t skipWhitespaceSIMD16(const C& input, size_t i) {
-			const size_t size = input.size();
-
-			static const __m128i ws_space = _mm_set1_epi8(' ');
-			static const __m128i ws_tab = _mm_set1_epi8('\t');
-			static const __m128i ws_cr = _mm_set1_epi8('\r');
-			static const __m128i ws_lf = _mm_set1_epi8('\n');
-
-			__m128i chunk;
-			uint16_t mask;
-
-			while (i + 16 <= size) {
-				chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
-
-				mask = ~_mm_movemask_epi8(_mm_or_si128(
-					_mm_or_si128(_mm_cmpeq_epi8(chunk, ws_space), _mm_cmpeq_epi8(chunk, ws_tab)),
-					_mm_or_si128(_mm_cmpeq_epi8(chunk, ws_cr), _mm_cmpeq_epi8(chunk, ws_lf))));
-
-				if (mask != 0) {
-					size_t j = i + CTZ16(mask);
-					if (input[j] == '/')
-					{
-						i = skipCommentSIMD16(input, j) + 1;
-						continue;
-					}
-					return j;
-				}
-
-				i += 16;
-			}
-
-			char c;
-			for (; i < input.size(); ++i)
-			{
-				c = input[i];
-				if (isWhitespace(c)) {
-					continue;
-				}
-				else if (c == commentStart) {
-					i = skipCommentScalar(input, i);
-					continue;
-				}
-				return i;
-			}
-			return i;
-		};
-#endif
-
-		template<Container C>
-		static inline size_t skipWhitespaceScalar(const C& input, size_t i) {
-			for (; i < input.size(); ++i) {
-				char c = input[i];
-				if (isWhitespace(c)) continue;
-				if (c == commentStart) {
-					i = skipCommentScalar(input, i);
-					continue;
-				}
-				return i;
-			}
-			return i;
-		}
-
 
 		template<Container C>
 		static inline size_t skipWhitespace(const C& input, size_t i) {
-#ifdef HAS_AVX2
-			return skipWhitespaceSIMD32(input, i);
-#elif defined(HAS_SSE2)
-			return skipWhitespaceSIMD16(input, i);
-#else 
-			return skipWhitespaceScalar(input, i);
-#endif
+			return Detail::skipWhitespace(&input[0], input.size(), i);
 		}
 
 		static inline bool isNumber(char c) {
 			return (c >= '0' && c <= '9') || c == '+' || c == '-' || c == 'e' || c == 'E' || c == decimalSeparator;			
 		}
 
-		template<Container C>
-		static inline Value parseNumber(C& input, size_t& i) {
-			std::string string;
+		template<Container C, Handler H>
+		static inline void parseNumber(C& input, size_t& i, H& handler) {
+			size_t start = i;
 			bool isFloat = false;
 
 			for (; i < input.size(); ++i) {
 				char c = input[i];				
 				if (!isNumber(c)) break;
 				if (c == decimalSeparator || c == 'e' || c == 'E') isFloat = true;
-				string.push_back(c);
 			}
 
-			if (isFloat) {
-				return Value(std::stod(string));
-			}
-			else {
-				return Value(std::stoi(string));
-			}
+			const char* data = &input[0];
+			Detail::parseNumber(Detail::skipLeadingPlus(data + start, data + i), data + i, isFloat, handler);
 		}
 
+		// Single pass: escape-free runs are located with SIMD and appended in bulk
+		// A string with nothing to escape is returned as a view into the input, otherwise it is decoded into decoded,
+		// which keeps unescaped control characters as they are
 		template<Container C>
-		static inline std::string parseString(C& input, size_t& i)
+		static inline std::string_view parseString(C& input, size_t& i, std::string& decoded)
 		{
-			++i;
-			size_t size = 0;
+			const char* data = &input[0];
+			const size_t size = input.size();
 
-			size_t end = i;
-			for (; end < input.size(); ++end, ++size) {
-				if (input[end] == stringEnd) break;
-				if (input[end] == escapedCharStart) ++end;
+			size_t runStart = ++i;
+			size_t end = Detail::findEscapeChar(data, size, i);
+			if (end >= size) throw std::runtime_error("Invalid string syntax");
+			if (data[end] == stringEnd) {
+				i = end + 1;
+				return std::string_view(data + runStart, end - runStart);
 			}
-			if (end >= input.size()) throw std::runtime_error("Invalid string syntax");
-			
-			std::string string;
-			string.reserve(size);
-			
-			char c;
-			for (; i < input.size(); ++i)
-			{
-				c = input[i];
-				if (c == stringEnd)
-				{
-					++i;
-					return string;
+
+			decoded.clear();
+			while (true) {
+				decoded.append(data + runStart, end - runStart);
+				if (data[end] == stringEnd) {
+					i = end + 1;
+					return decoded;
+				}
+				if (data[end] == escapedCharStart) {
+					i = end + 1;
+					Detail::decodeEscape(data, input.size(), i, decoded);
+					runStart = i + 1;
 				}
-				else if (c == escapedCharStart)
-					handleEscapedChar(input, ++i, string);
-				else string.push_back(c);
+				else {
+					decoded.push_back(data[end]);
+					runStart = end + 1;
+				}
+				end = Detail::findEscapeChar(data, size, runStart);
+				if (end >= size) throw std::runtime_error("Invalid string syntax");
 			}
-			throw std::runtime_error("Invalid string syntax");
 		}
 
 		template<Container C>
-		static inline Value parseLiteral(C& input, size_t& i, const std::string& literal, Value value)
+		static inline void parseLiteral(C& input, size_t& i, const std::string& literal)
 		{
 			++i;
 			for (size_t j = 1; j < literal.size() && i < input.size(); ++j, ++i) {
@@ -408,50 +113,48 @@ namespace Json
 					throw std::runtime_error("Invalid " + literal + " literal");
 				}
 			}
-			return value;
 		}
 
-		template<Container C>
-		static Value parseArray(C& input, size_t& i) {
-			Value value = Value::array();
-			auto& array = value.asArray();
+		template<Container C, Handler H>
+		static void parseArray(C& input, size_t& i, H& handler) {
+			handler.onStartArray();
 			while (true) {
 				i = skipWhitespace(input, ++i);
 				if (i >= input.size()) throw std::runtime_error("Endless array");
-				if (input[i] == endArray) { ++i; return value; }
+				if (input[i] == endArray) { ++i; handler.onEndArray(); return; }
 				
-				array.emplace_back(parseValue(input, i));
+				parseValue(input, i, handler);
 				i = skipWhitespace(input, i);
 				if (i >= input.size()) throw std::runtime_error("Endless array");
 				
-				if (input[i] == endArray) { ++i; return value; }
+				if (input[i] == endArray) { ++i; handler.onEndArray(); return; }
 				if (input[i] != valueSeparator) throw std::runtime_error("Expected ',' or ']'");
 			}
 		}
 
-		template<Container C>
-		static Value parseObject(C& input, size_t& i) {
-			Value value = Value::object();
-			auto& object = value.asObject();
+		template<Container C, Handler H>
+		static void parseObject(C& input, size_t& i, H& handler) {
+			handler.onStartObject();
 			while (true) {
 				i = skipWhitespace(input, ++i);
 				if (i >= input.size()) throw std::runtime_error("Endless object");
-				if (input[i] == endObject) { ++i; return value; }
+				if (input[i] == endObject) { ++i; handler.onEndObject(); return; }
 				if (input[i] != stringStart) throw std::runtime_error("Expected string key");
 				
-				std::string name = parseString(input, i);
-				if (object.find(name) != object.end()) throw std::runtime_error("Duplicate key: " + name);
+				std::string decoded;
+				const std::string_view key = parseString(input, i, decoded);
+				Detail::reportKey(handler, key, key.data() != decoded.data());
 				
 				i = skipWhitespace(input, i);
 				if (i >= input.size() || input[i] != nameSeparator) throw std::runtime_error("Expected ':'");
 				
 				i = skipWhitespace(input, ++i);
-				object[name] = parseValue(input, i);
+				parseValue(input, i, handler);
 				
 				i = skipWhitespace(input, i);
 				if (i >= input.size()) throw std::runtime_error("Endless object");
 				
-				if (input[i] == endObject) { ++i; return value; }
+				if (input[i] == endObject) { ++i; handler.onEndObject(); return; }
 				if (input[i] != valueSeparator) throw std::runtime_error("Expected ',' or '}'");
 			}
 		}
@@ -460,40 +163,52 @@ namespace Json
 			return (c >= '0' && c <= '9') || c == '+' || c == '-';
 		}
 
-		template<Container C>
-		static Value parseValue(C& input, size_t& i) {
+		template<Container C, Handler H>
+		static void parseValue(C& input, size_t& i, H& handler) {
 			char c = input[i];
 			switch (c) {
-			case beginObject: return parseObject(input, i);
-			case beginArray: return parseArray(input, i);
-			case stringStart: return Value(parseString(input, i));
-			case 't': return parseLiteral(input, i, trueLiteral, Value(true));
-			case 'f': return parseLiteral(input, i, falseLiteral, Value(false));
-			case 'n': return parseLiteral(input, i, nullLiteral, Value(nullptr));
+			case beginObject: parseObject(input, i, handler); return;
+			case beginArray: parseArray(input, i, handler); return;
+			case stringStart: {
+				std::string decoded;
+				const std::string_view value = parseString(input, i, decoded);
+				Detail::reportString(handler, value, value.data() != decoded.data());
+				return;
+			}
+			case 't': parseLiteral(input, i, trueLiteral); handler.onBool(true); return;
+			case 'f': parseLiteral(input, i, falseLiteral); handler.onBool(false); return;
+			case 'n': parseLiteral(input, i, nullLiteral); handler.onNull(); return;
 			default:
-				if (isNumberStart(c)) return parseNumber(input, i);
+				if (isNumberStart(c)) { parseNumber(input, i, handler); return; }
 				throw std::runtime_error(std::string("Invalid value: ") + c);
 			}
 		}
 
 	public:
-		template<Container C>
-		static std::vector<Value> parse(C& input)
+		// Reports every root value in the input to the handler as a stream of events
+		template<Container C, Handler H>
+		static void parse(C& input, H& handler)
 		{
-			std::vector<Value> document;
 			try {
 				for (size_t i = 0; i < input.size();)
 				{
 					i = skipWhitespace(input, i);
 					if (i >= input.size())
 						break;
-					document.push_back(std::move(parseValue(input, i)));
+					parseValue(input, i, handler);
 				}
 			}
 			catch (const std::exception& e) {
 				throw std::runtime_error(std::string("JSON parsing failed: ") + e.what());
 			}
-			return document;
+		}
+
+		template<Container C>
+		static std::vector<Value> parse(C& input)
+		{
+			ValueBuilder<Value, true> builder;
+			parse(input, builder);
+			return builder.release();
 		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <concepts>
+
+#include "JsonParser/Value.h"
+#include "JsonParser/ValueBuilder.h"
+#include "JsonParser/Utils/Macros.h"
+#include "JsonParser/Utils/MappedFile.h"
+
+namespace Json
+{
+	struct DocumentOptions
+	{
+		// Store arrays of only integers or only doubles contiguously, see Value::pushBackPacked
+		bool packed = false;
+		// Store arrays of same-shaped objects column by column, see Value::pushBackColumnar
+		bool columnar = false;
+	};
+
+	// Values parsed in place: escape-free strings and keys are views into the input instead of copies,
+	// only strings containing escape sequences are decoded into storage of their own
+	// The document keeps its input alive. A std::string or MappedFile passed as an rvalue is moved into it,
+	// any other input (string_view, lvalue string or MappedFile) is borrowed and has to outlive the document
+	// The values are read-only, a copy of one owns all of its strings and may outlive the document
+	//
+	// All containers and decoded strings are allocated from a monotonic arena owned by the document,
+	// destroying it frees the arena's few large blocks without visiting a single value
+	class Document
+	{
+	public:
+		using Options = DocumentOptions;
+
+	private:
+		static constexpr size_t minimumArenaBlock = 4096;
+
+		std::shared_ptr<const void> m_owner;
+		std::unique_ptr<std::pmr::monotonic_buffer_resource> m_arena;
+		// Lives in the arena and is never destroyed, like everything it points to
+		std::span<const Value> m_roots;
+
+		using Input = std::pair<std::shared_ptr<const void>, std::string_view>;
+
+		static Input hold(std::string_view input) {
+			return { nullptr, input };
+		}
+
+		static Input hold(std::string&& input) {
+			auto owner = std::make_shared<const std::string>(std::move(input));
+			return { owner, *owner };
+		}
+
+		template<bool writable>
+		static Input hold(MappedFile<writable>&& file) {
+			auto owner = std::make_shared<const MappedFile<writable>>(std::move(file));
+			return { owner, *owner };
+		}
+
+		template<typename Parser, bool rejectDuplicateKeys, typename T>
+		static Document build(T&& input, Options options) {
+			Document document;
+			auto [owner, view] = hold(std::forward<T>(input));
+			document.m_owner = std::move(owner);
+			// The tree takes about as much memory as its text, so the first block usually suffices
+			document.m_arena = std::make_unique<std::pmr::monotonic_buffer_resource>(std::max(view.size(), minimumArenaBlock));
+
+			ValueBuilder<Value, rejectDuplicateKeys> builder(view, document.m_arena.get());
+			builder.setPacked(options.packed);
+			builder.setColumnar(options.columnar);
+			Parser::parse(view, builder);
+
+			std::vector<Value>& roots = builder.roots();
+			Value* storage = static_cast<Value*>(document.m_arena->allocate(sizeof(Value) * roots.size(), alignof(Value)));
+			for (size_t i = 0; i < roots.size(); ++i) {
+				new (storage + i) Value(std::move(roots[i]));
+			}
+			document.m_roots = std::span<const Value>(storage, roots.size());
+			return document;
+		}
+
+	public:
+		Document() = default;
+
+		Document(Document&& other) noexcept
+			: m_owner(std::move(other.m_owner)), m_arena(std::move(other.m_arena)), m_roots(std::exchange(other.m_roots, {})) {}
+
+		Document& operator=(Document&& other) noexcept {
+			if (this != &other) {
+				m_roots = std::exchange(other.m_roots, {});
+				m_arena = std::move(other.m_arena);
+				m_owner = std::move(other.m_owner);
+			}
+			return *this;
+		}
+		Document(const Document&) = delete;
+		Document& operator=(const Document&) = delete;
+
+		// Same rules as Value::parse, comments, trailing commas and multiple roots are accepted
+		template<typename T> requires std::convertible_to<T, std::string_view>
+		static Document parse(T&& input, Options options = {}) {
+			return build<ContainerParser<Value>, true>(std::forward<T>(input), options);
+		}
+
+		// Same rules as Value::parseStrict
+		template<typename T> requires std::convertible_to<T, std::string_view>
+		static Document parseStrict(T&& input, Options options = {}) {
+			return build<StrictContainerParser<Value>, false>(std::forward<T>(input), options);
+		}
+
+		// Same rules as Value::parseIndexed
+		template<typename T> requires std::convertible_to<T, std::string_view>
+		static Document parseIndexed(T&& input, Options options = {}) {
+			return build<StructuralParser<Value>, false>(std::forward<T>(input), options);
+		}
+
+		// Maps the file and keeps the mapping for the lifetime of the document
+		static Document fromFile(std::string_view path, Options options = {}) {
+			return parse(MappedFile<>(path.data()), options);
+		}
+
+		bool empty() const { return m_roots.empty(); }
+		size_t size() const { return m_roots.size(); }
+
+		std::span<const Value> roots() const { return m_roots; }
+
+		const Value& root() const {
+			JSON_VERIFY(!m_roots.empty(), "Empty document");
+			return m_roots.front();
+		}
+
+		const Value& operator[](size_t index) const { return m_roots[index]; }
+	};
+}
\ No newline at end of file
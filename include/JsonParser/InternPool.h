@@ -0,0 +1,105 @@
+#pragma once
+#include <stdint.h>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "JsonParser/Object.h"
+#include "JsonParser/String.h"
+
+namespace Json
+{
+	// Interns object keys and short string values across everything parsed with it (see ValueBuilder), such as
+	// the records of an NDJSON stream parsed one call at a time: each distinct string is stored once and its
+	// copies share the buffer, its hash and compare equal by pointer (see String), and objects with the same keys
+	// share one Shape across all documents
+	// Values keep the strings and shapes they use alive, the pool may be destroyed before them
+	// Past maxEntries interned strings (or shapes) the pool stops adding new ones, which are then stored the usual
+	// way, so unique values such as ids cannot grow it without bound
+	// A thread-safe pool may be used by builders on several threads at once, it locks for every lookup
+	class InternPool
+	{
+	public:
+		// Longer strings are seldom repeated and are not interned
+		static constexpr size_t maxStringLength = 64;
+
+	private:
+		struct StringHash {
+			using is_transparent = void;
+			size_t operator()(const String& value) const noexcept { return value.hash(); }
+			size_t operator()(std::string_view value) const noexcept { return std::hash<std::string_view>{}(value); }
+		};
+
+		struct StringEqual {
+			using is_transparent = void;
+			bool operator()(std::string_view lhs, std::string_view rhs) const noexcept { return lhs == rhs; }
+		};
+
+		// The key views the last key of the child shape
+		struct Transition {
+			const Shape* parent;
+			std::string_view key;
+
+			friend bool operator==(const Transition& lhs, const Transition& rhs) noexcept = default;
+		};
+
+		struct TransitionHash {
+			size_t operator()(const Transition& transition) const noexcept {
+				return std::hash<std::string_view>{}(transition.key) ^ std::hash<const void*>{}(transition.parent) * 0x9E3779B97F4A7C15ull;
+			}
+		};
+
+		std::unordered_set<String, StringHash, StringEqual> m_strings;
+		std::unordered_map<Transition, const Shape*, TransitionHash> m_shapes;
+		size_t m_maxEntries;
+		bool m_threadSafe;
+		std::mutex m_mutex;
+
+		inline std::unique_lock<std::mutex> lock() {
+			return m_threadSafe ? std::unique_lock<std::mutex>(m_mutex) : std::unique_lock<std::mutex>();
+		}
+
+	public:
+		explicit InternPool(bool threadSafe = false, size_t maxEntries = size_t(1) << 20)
+			: m_maxEntries(maxEntries), m_threadSafe(threadSafe) {}
+
+		~InternPool() {
+			for (const auto& [transition, shape] : m_shapes) Shape::release(shape);
+		}
+
+		InternPool(const InternPool&) = delete;
+		InternPool& operator=(const InternPool&) = delete;
+
+		// A copy of the interned String equal to value, or a String of its own when value is inline, too long or
+		// the pool is full
+		String intern(std::string_view value) {
+			if (value.size() <= String::inlineCapacity || value.size() > maxStringLength) return String(value);
+			auto guard = lock();
+			auto it = m_strings.find(value);
+			if (it != m_strings.end()) return *it;
+			if (m_strings.size() >= m_maxEntries) return String(value);
+			return *m_strings.insert(String(value)).first;
+		}
+
+		// The shape of parent's keys followed by key, nullptr when the pool is full
+		// It stays alive with the pool, retain it to keep it longer
+		const Shape* shape(const Shape* parent, const String& key) {
+			auto guard = lock();
+			auto it = m_shapes.find({ parent, key.view() });
+			if (it != m_shapes.end()) return it->second;
+			if (m_shapes.size() >= m_maxEntries) return nullptr;
+			const Shape* shape = Shape::extend(parent, key, nullptr);
+			m_shapes.emplace(Transition{ parent, shape->keys().back().view() }, shape);
+			return shape;
+		}
+
+		// Interned strings and shapes
+		size_t size() {
+			auto guard = lock();
+			return m_strings.size() + m_shapes.size();
+		}
+	};
+}
\ No newline at end of file
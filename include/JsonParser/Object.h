@@ -0,0 +1,694 @@
+#pragma once
+#include <stdint.h>
+#include <cstddef>
+#include <cstring>
+#include <atomic>
+#include <bit>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <algorithm>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "JsonParser/Array.h"
+#include "JsonParser/String.h"
+#include "JsonParser/Utils/SIMDUtils.h"
+
+namespace Json
+{
+	namespace Detail
+	{
+		// Position of key among count Strings, count when it is missing
+		// A short key is compared to each String as one 16-byte vector, which works because short Strings
+		// are always inline (see String)
+		template<typename KeyAt>
+		inline size_t findKey(std::string_view key, size_t count, KeyAt keyAt) noexcept {
+			if (key.size() > String::inlineCapacity) {
+				for (size_t i = 0; i < count; ++i) {
+					if (keyAt(i) == key) return i;
+				}
+				return count;
+			}
+
+			const String probe = String::borrow(key);
+#ifdef HAS_SSE2
+			const __m128i expected = _mm_loadu_si128(reinterpret_cast<const __m128i*>(probe.bytes()));
+			for (size_t i = 0; i < count; ++i) {
+				const __m128i actual = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keyAt(i).bytes()));
+				if (_mm_movemask_epi8(_mm_cmpeq_epi8(expected, actual)) == 0xFFFF) return i;
+			}
+#else
+			for (size_t i = 0; i < count; ++i) {
+				if (std::memcmp(probe.bytes(), keyAt(i).bytes(), 16) == 0) return i;
+			}
+#endif
+			return count;
+		}
+	}
+
+	// Keys of an object in member order, shared by all objects parsed with the same keys in the same order
+	// (see ValueBuilder), each of which then only stores its values
+	// Immutable once created and reference counted by the objects using them. Heap shapes own their keys, shapes
+	// allocated from a memory_resource are freed back into it and may borrow their keys like a Document's strings
+	class Shape
+	{
+	public:
+		// Objects with more keys are indexed by their own hash table instead
+		static constexpr size_t maxKeys = 16;
+
+	private:
+		static inline std::atomic<uint64_t> s_nextId = 1;
+
+		BasicArray<String> m_keys;
+		uint64_t m_id;
+		mutable std::atomic<uint32_t> m_references = 1;
+
+		explicit Shape(std::pmr::memory_resource* resource) noexcept
+			: m_keys(resource), m_id(s_nextId.fetch_add(1, std::memory_order_relaxed)) {}
+
+		static Shape* allocate(std::pmr::memory_resource* resource) {
+			if (!resource) return new Shape(nullptr);
+			return new (resource->allocate(sizeof(Shape), alignof(Shape))) Shape(resource);
+		}
+
+		// Heap shapes own their keys, resource shapes borrow what they can and allocate the rest from the resource
+		inline String copyKey(const String& key) const {
+			std::pmr::memory_resource* resource = m_keys.resource();
+			return resource && key.isBorrowed() ? key.borrowOrCopy() : String(key, resource);
+		}
+
+	public:
+		Shape(const Shape&) = delete;
+		Shape& operator=(const Shape&) = delete;
+
+		// The caller holds the only reference
+		static const Shape* create(std::span<const String> keys, std::pmr::memory_resource* resource) {
+			Shape* shape = allocate(resource);
+			shape->m_keys.reserve(keys.size());
+			for (const String& key : keys) shape->m_keys.push_back(shape->copyKey(key));
+			return shape;
+		}
+
+		// parent's keys followed by key, parent may be nullptr for no keys
+		static const Shape* extend(const Shape* parent, const String& key, std::pmr::memory_resource* resource) {
+			Shape* shape = allocate(resource);
+			const size_t size = parent ? parent->size() : 0;
+			shape->m_keys.reserve(size + 1);
+			for (size_t i = 0; i < size; ++i) shape->m_keys.push_back(shape->copyKey(parent->m_keys[i]));
+			shape->m_keys.push_back(shape->copyKey(key));
+			return shape;
+		}
+
+		static void retain(const Shape* shape) noexcept {
+			if (shape) shape->m_references.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// Frees the shape with its last reference, into the resource it came from
+		static void release(const Shape* shape) noexcept {
+			if (!shape || shape->m_references.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+			std::pmr::memory_resource* resource = shape->resource();
+			if (!resource) {
+				delete shape;
+				return;
+			}
+			shape->~Shape();
+			resource->deallocate(const_cast<Shape*>(shape), sizeof(Shape), alignof(Shape));
+		}
+
+		// nullptr for the global heap
+		std::pmr::memory_resource* resource() const noexcept { return m_keys.resource(); }
+
+		// Distinct for every shape ever created, see Key
+		uint64_t id() const noexcept { return m_id; }
+
+		size_t size() const noexcept { return m_keys.size(); }
+		std::span<const String> keys() const noexcept { return { m_keys.data(), m_keys.size() }; }
+
+		// Position of key, size() when it is missing
+		size_t find(std::string_view key) const noexcept {
+			return Detail::findKey(key, m_keys.size(), [this](size_t i) -> const String& { return m_keys[i]; });
+		}
+	};
+
+	// Object key that remembers its position in the last shaped object it was found in, looking it up again in
+	// an object of the same shape (another row of a parsed array) then takes a single comparison
+	// The cache is one atomic word, a Key may be shared between threads
+	class Key
+	{
+	private:
+		template<typename T>
+		friend class BasicObject;
+
+		String m_name;
+		// Shape id above the low 8 bits, position in them
+		mutable std::atomic<uint64_t> m_cache = 0;
+
+		static constexpr size_t notCached = SIZE_MAX;
+
+		inline size_t cached(uint64_t shape) const noexcept {
+			const uint64_t cache = m_cache.load(std::memory_order_relaxed);
+			return (cache >> 8) == shape ? static_cast<size_t>(cache & 0xFF) : notCached;
+		}
+
+		inline void cache(uint64_t shape, size_t position) const noexcept {
+			m_cache.store(shape << 8 | position, std::memory_order_relaxed);
+		}
+
+	public:
+		explicit Key(std::string_view name) : m_name(name) {}
+		Key(const Key& other) : m_name(other.m_name), m_cache(other.m_cache.load(std::memory_order_relaxed)) {}
+		Key& operator=(const Key& other) {
+			m_name = other.m_name;
+			m_cache.store(other.m_cache.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			return *this;
+		}
+
+		std::string_view name() const noexcept { return m_name; }
+	};
+
+	// Object members in insertion order, which is also the iteration order, stored one of two ways:
+	//   shaped      a Shape holding the keys, shared with other objects, and an array of values
+	//               Parsed objects of up to Shape::maxKeys members are built this way (see ValueBuilder), the first
+	//               change to their keys gives them keys of their own. Copies share heap shapes
+	//   dictionary  an array of key and value pairs
+	//               Small dictionaries are searched linearly, past indexThreshold members lookups go through a hash
+	//               index of member positions laid out like a Swiss table: a control byte per slot holding 7 bits of
+	//               the key's hash, probed 16 slots at a time with one vector compare, so key comparisons are only
+	//               made for slots whose control byte matches
+	// Members, and keys added by name, are allocated like BasicArray elements, from a memory_resource or the heap,
+	// copies use the heap
+	// Iterators yield pairs of references to the key, which is read-only, and the value. Each dereference rebuilds
+	// the pair inside the iterator and returns it by reference, so for (auto& [key, value] : object) binds to it
+	// and changes values in place; the pair is valid until the iterator is dereferenced again or destroyed
+	template<typename T>
+	class BasicObject
+	{
+	public:
+		template<bool constant>
+		class Iterator
+		{
+		private:
+			friend class BasicObject;
+			template<bool>
+			friend class Iterator;
+
+			using Object = std::conditional_t<constant, const BasicObject, BasicObject>;
+			using Mapped = std::conditional_t<constant, const T, T>;
+
+		public:
+			// References are returned into the iterator, which makes it an input iterator for the standard library
+			using iterator_category = std::input_iterator_tag;
+			using difference_type = ptrdiff_t;
+			using value_type = std::pair<const String, T>;
+			using reference = std::pair<const String&, Mapped&>;
+			using pointer = const reference*;
+
+		private:
+			Object* m_object = nullptr;
+			size_t m_position = 0;
+			// Never copied or assigned: assigning a pair of references would assign to the key and the value
+			mutable std::optional<reference> m_member;
+
+			Iterator(Object* object, size_t position) noexcept : m_object(object), m_position(position) {}
+
+		public:
+			Iterator() noexcept = default;
+			Iterator(const Iterator& other) noexcept : m_object(other.m_object), m_position(other.m_position) {}
+			template<bool otherConstant> requires (constant && !otherConstant)
+			Iterator(const Iterator<otherConstant>& other) noexcept : m_object(other.m_object), m_position(other.m_position) {}
+
+			Iterator& operator=(const Iterator& other) noexcept {
+				m_object = other.m_object;
+				m_position = other.m_position;
+				m_member.reset();
+				return *this;
+			}
+
+			const reference& operator*() const noexcept {
+				m_member.emplace(m_object->keyAt(m_position), m_object->valueAt(m_position));
+				return *m_member;
+			}
+			pointer operator->() const noexcept { return &**this; }
+
+			Iterator& operator++() noexcept { ++m_position; return *this; }
+			Iterator operator++(int) noexcept { Iterator it = *this; ++m_position; return it; }
+			Iterator& operator--() noexcept { --m_position; return *this; }
+			Iterator operator--(int) noexcept { Iterator it = *this; --m_position; return it; }
+
+			friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+				return lhs.m_position == rhs.m_position && lhs.m_object == rhs.m_object;
+			}
+		};
+
+		using key_type = String;
+		using mapped_type = T;
+		using value_type = std::pair<const String, T>;
+		using size_type = size_t;
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+
+		static constexpr size_t indexThreshold = 16;
+
+	private:
+		static constexpr size_t groupSize = 16;
+		static constexpr uint8_t emptySlot = 0x80;
+		// Slot of an erased member, probes continue past it and appends reuse it
+		static constexpr uint8_t erasedSlot = 0xFE;
+
+		static constexpr size_t groupBytes = groupSize * (1 + sizeof(uint32_t));
+
+		// Key and value of a dictionary member
+		using Member = std::pair<String, T>;
+
+		union {
+			BasicArray<Member> m_members;
+			BasicArray<T> m_values;
+		};
+		union {
+			// Groups of 16 control bytes (emptySlot, erasedSlot or the low 7 bits of the key's hash) each followed by the member
+			// positions of its slots, so a probe mostly stays within one or two adjacent cache lines
+			// Twice the member capacity rounded up to a power of two slots, rebuilt whenever the members grow
+			uint8_t* m_index = nullptr;
+			// nullptr while a shaped object is empty
+			const Shape* m_shape;
+		};
+		bool m_shaped = false;
+		// erasedSlot control bytes in the index, which is rebuilt once they take a quarter of its slots
+		uint32_t m_erasedSlots = 0;
+
+		static inline size_t indexSize(size_t capacity) noexcept {
+			return std::max(std::bit_ceil(capacity * 2), groupSize);
+		}
+
+		static inline size_t indexBytes(size_t size) noexcept {
+			return size / groupSize * groupBytes;
+		}
+
+		static inline size_t hash(std::string_view key) noexcept {
+			return std::hash<std::string_view>{}(key);
+		}
+
+		// Bit i set when control byte i of the group equals value
+		static inline uint32_t matchGroup(const uint8_t* group, uint8_t value) noexcept {
+#ifdef HAS_SSE2
+			const __m128i control = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+			return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(static_cast<char>(value)))));
+#else
+			uint32_t mask = 0;
+			for (size_t i = 0; i < groupSize; ++i) mask |= static_cast<uint32_t>(group[i] == value) << i;
+			return mask;
+#endif
+		}
+
+		// Bit i set when slot i of the group is empty or erased, the only control bytes with the high bit set
+		static inline uint32_t matchFree(const uint8_t* group) noexcept {
+#ifdef HAS_SSE2
+			return static_cast<uint32_t>(_mm_movemask_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+			uint32_t mask = 0;
+			for (size_t i = 0; i < groupSize; ++i) mask |= static_cast<uint32_t>(group[i] >> 7) << i;
+			return mask;
+#endif
+		}
+
+		inline uint32_t* positions(uint8_t* group) const noexcept {
+			return reinterpret_cast<uint32_t*>(group + groupSize);
+		}
+
+		void freeIndex() noexcept {
+			if (!m_index) return;
+			const size_t bytes = indexBytes(indexSize(m_members.capacity()));
+			if (std::pmr::memory_resource* resource = m_members.resource()) resource->deallocate(m_index, bytes, groupSize);
+			else ::operator delete(m_index, bytes, std::align_val_t(groupSize));
+			m_index = nullptr;
+			m_erasedSlots = 0;
+		}
+
+		// Call with the index freed (or never built) for the current capacity
+		void buildIndex() {
+			const size_t size = indexSize(m_members.capacity());
+			const size_t bytes = indexBytes(size);
+			std::pmr::memory_resource* resource = m_members.resource();
+			m_index = static_cast<uint8_t*>(resource ? resource->allocate(bytes, groupSize) : ::operator new(bytes, std::align_val_t(groupSize)));
+			fillIndex();
+		}
+
+		// Indexes every member into an index of the current size
+		void fillIndex() noexcept {
+			std::memset(m_index, emptySlot, indexBytes(indexSize(m_members.capacity())));
+			m_erasedSlots = 0;
+			for (size_t i = 0; i < m_members.size(); ++i) indexMember(i);
+		}
+
+		// Groups are visited in triangular order, which reaches all of them for a power-of-two count
+		inline void indexMember(size_t position) noexcept {
+			const size_t lastGroup = indexSize(m_members.capacity()) / groupSize - 1;
+			const size_t keyHash = m_members[position].first.hash();
+			for (size_t group = (keyHash >> 7) & lastGroup, step = 1;; group = (group + step++) & lastGroup) {
+				uint8_t* control = m_index + group * groupBytes;
+				const uint32_t free = matchFree(control);
+				if (free) {
+					const size_t slot = CTZ32(free);
+					if (control[slot] == erasedSlot) --m_erasedSlots;
+					control[slot] = static_cast<uint8_t>(keyHash & 0x7F);
+					positions(control)[slot] = static_cast<uint32_t>(position);
+					return;
+				}
+			}
+		}
+
+
+		size_t findIndexed(std::string_view key) const noexcept {
+			const size_t lastGroup = indexSize(m_members.capacity()) / groupSize - 1;
+			const size_t keyHash = hash(key);
+			for (size_t group = (keyHash >> 7) & lastGroup, step = 1;; group = (group + step++) & lastGroup) {
+				uint8_t* control = m_index + group * groupBytes;
+				for (uint32_t match = matchGroup(control, static_cast<uint8_t>(keyHash & 0x7F)); match; match &= match - 1) {
+					const size_t position = positions(control)[CTZ32(match)];
+					if (m_members[position].first == key) return position;
+				}
+				if (matchGroup(control, emptySlot)) return m_members.size();
+			}
+		}
+
+		// The control byte and the stored position of the slot indexing the member at position
+		std::pair<uint8_t*, uint32_t*> slotOf(size_t position) noexcept {
+			const size_t lastGroup = indexSize(m_members.capacity()) / groupSize - 1;
+			const size_t keyHash = m_members[position].first.hash();
+			for (size_t group = (keyHash >> 7) & lastGroup, step = 1;; group = (group + step++) & lastGroup) {
+				uint8_t* control = m_index + group * groupBytes;
+				for (uint32_t match = matchGroup(control, static_cast<uint8_t>(keyHash & 0x7F)); match; match &= match - 1) {
+					const size_t slot = CTZ32(match);
+					if (positions(control)[slot] == position) return { control + slot, positions(control) + slot };
+				}
+			}
+		}
+
+		// Marks the slot of the member at position erased and moves the positions of the members after it down by
+		// one, called before the member is erased: a probe per member that moves, or for more than an eighth of the
+		// slots one pass over all stored positions, which hashes nothing. Returns true instead once erased slots
+		// take a quarter of the index, which is then rebuilt after the erase
+		bool unindexMember(size_t position) noexcept {
+			*slotOf(position).first = erasedSlot;
+			const size_t slots = indexSize(m_members.capacity());
+			if (++m_erasedSlots * 4 >= slots) return true;
+			if ((m_members.size() - position) * 8 < slots) {
+				for (size_t i = position + 1; i < m_members.size(); ++i) --*slotOf(i).second;
+				return false;
+			}
+			for (uint8_t* control = m_index; control != m_index + indexBytes(slots); control += groupBytes) {
+				uint32_t* slotPositions = positions(control);
+				for (size_t slot = 0; slot < groupSize; ++slot) {
+					if (!(control[slot] & 0x80) && slotPositions[slot] > position) --slotPositions[slot];
+				}
+			}
+			return false;
+		}
+
+		inline size_t position(std::string_view key) const noexcept {
+			if (m_shaped) return m_shape ? m_shape->find(key) : 0;
+			if (m_index) return findIndexed(key);
+			return Detail::findKey(key, m_members.size(), [this](size_t i) -> const String& { return m_members[i].first; });
+		}
+
+		inline size_t position(const Key& key) const noexcept {
+			if (!m_shaped || !m_shape) return position(key.name());
+			size_t found = key.cached(m_shape->id());
+			if (found == Key::notCached) {
+				found = m_shape->find(key.name());
+				if (found != m_shape->size()) key.cache(m_shape->id(), found);
+			}
+			return found;
+		}
+
+		inline const String& keyAt(size_t position) const noexcept {
+			return m_shaped ? m_shape->keys()[position] : m_members[position].first;
+		}
+
+		inline T& valueAt(size_t position) noexcept {
+			return m_shaped ? m_values[position] : m_members[position].second;
+		}
+
+		inline const T& valueAt(size_t position) const noexcept {
+			return m_shaped ? m_values[position] : m_members[position].second;
+		}
+
+		// Gives a shaped object keys of its own before they change, borrowing what the shape borrows
+		void detach() {
+			if (!m_shaped) return;
+			BasicArray<Member> members(m_values.resource());
+			members.reserve(m_values.size());
+			for (size_t i = 0; i < m_values.size(); ++i) {
+				members.emplace_back(std::piecewise_construct,
+					std::forward_as_tuple(m_shape->keys()[i].borrowOrCopy()), std::forward_as_tuple(std::move(m_values[i])));
+			}
+			destroyStorage();
+			new (&m_members) BasicArray<Member>(std::move(members));
+			m_index = nullptr;
+			m_shaped = false;
+			if (m_members.size() > indexThreshold) buildIndex();
+		}
+
+		// Leaves the unions without live members
+		void destroyStorage() noexcept {
+			if (m_shaped) {
+				m_values.~BasicArray();
+				Shape::release(m_shape);
+			}
+			else {
+				freeIndex();
+				m_members.~BasicArray();
+			}
+		}
+
+		// Takes over other's storage, call with the unions without live members
+		void steal(BasicObject& other) noexcept {
+			m_shaped = other.m_shaped;
+			if (m_shaped) {
+				new (&m_values) BasicArray<T>(std::move(other.m_values));
+				m_shape = std::exchange(other.m_shape, nullptr);
+			}
+			else {
+				new (&m_members) BasicArray<Member>(std::move(other.m_members));
+				m_index = std::exchange(other.m_index, nullptr);
+				m_erasedSlots = std::exchange(other.m_erasedSlots, 0);
+			}
+		}
+
+		// Appends without looking for key, keeping the index in step with the member capacity
+		template<typename... Args>
+		size_t append(String&& key, Args&&... args) {
+			detach();
+			const size_t capacity = m_members.capacity();
+			if (m_index && m_members.size() == capacity) {
+				freeIndex();
+				m_members.reserve(capacity * 2);
+				buildIndex();
+			}
+			m_members.emplace_back(std::piecewise_construct,
+				std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+			const size_t position = m_members.size() - 1;
+			if (m_index) indexMember(position);
+			else if (m_members.size() > indexThreshold) buildIndex();
+			return position;
+		}
+
+	public:
+		BasicObject() noexcept : m_members() {}
+		explicit BasicObject(std::pmr::memory_resource* resource) noexcept : m_members(resource) {}
+
+		~BasicObject() {
+			destroyStorage();
+		}
+
+		// Shares the shape of a heap shaped object, a copy of any other has its own keys
+		BasicObject(const BasicObject& other) : m_members() {
+			if (other.m_shaped && other.m_shape && !other.m_shape->resource()) {
+				m_members.~BasicArray();
+				new (&m_values) BasicArray<T>(other.m_values);
+				m_shaped = true;
+				Shape::retain(other.m_shape);
+				m_shape = other.m_shape;
+				return;
+			}
+			m_members.reserve(other.size());
+			for (size_t i = 0; i < other.size(); ++i) m_members.emplace_back(other.keyAt(i), other.valueAt(i));
+			if (m_members.size() > indexThreshold) buildIndex();
+		}
+
+		BasicObject(BasicObject&& other) noexcept {
+			steal(other);
+		}
+
+		BasicObject& operator=(const BasicObject& other) {
+			if (this != &other) {
+				BasicObject copy(other);
+				*this = std::move(copy);
+			}
+			return *this;
+		}
+
+		// Takes other's storage when both objects allocate from the same resource. Otherwise the members are moved
+		// into storage allocated from this object's resource, which can throw, and the object is left unchanged if it does
+		BasicObject& operator=(BasicObject&& other) {
+			if (this == &other) return *this;
+			if (resource() != other.resource()) {
+				BasicObject moved(resource());
+				moved.m_members.reserve(other.size());
+				for (size_t i = 0; i < other.size(); ++i) moved.append(other.keyAt(i).borrowOrCopy(), std::move(other.valueAt(i)));
+				other.clear();
+				return *this = std::move(moved);
+			}
+			destroyStorage();
+			steal(other);
+			return *this;
+		}
+
+		// nullptr for the global heap
+		std::pmr::memory_resource* resource() const noexcept { return m_shaped ? m_values.resource() : m_members.resource(); }
+
+		size_t size() const noexcept { return m_shaped ? m_values.size() : m_members.size(); }
+		bool empty() const noexcept { return size() == 0; }
+
+		// nullptr unless the object is shaped and not empty
+		const Shape* shape() const noexcept { return m_shaped ? m_shape : nullptr; }
+
+		iterator begin() noexcept { return { this, 0 }; }
+		iterator end() noexcept { return { this, size() }; }
+		const_iterator begin() const noexcept { return { this, 0 }; }
+		const_iterator end() const noexcept { return { this, size() }; }
+		const_iterator cbegin() const noexcept { return begin(); }
+		const_iterator cend() const noexcept { return end(); }
+
+		void reserve(size_t capacity) {
+			detach();
+			if (capacity <= m_members.capacity()) return;
+			const bool indexed = m_index != nullptr;
+			freeIndex();
+			m_members.reserve(capacity);
+			if (indexed) buildIndex();
+		}
+
+		// Makes an empty object shaped, the values are moved in, one per key of shape
+		// Used by ValueBuilder, which keeps the values of an object aside until it has seen all of its keys
+		void assign(const Shape* shape, T* values) {
+			if (!m_shaped) {
+				std::pmr::memory_resource* resource = m_members.resource();
+				destroyStorage();
+				new (&m_values) BasicArray<T>(resource);
+				m_shape = nullptr;
+				m_shaped = true;
+			}
+			m_values.reserve(shape->size());
+			for (size_t i = 0; i < shape->size(); ++i) m_values.emplace_back(std::move(values[i]));
+			Shape::retain(shape);
+			m_shape = shape;
+		}
+
+		iterator find(std::string_view key) noexcept { return { this, position(key) }; }
+		const_iterator find(std::string_view key) const noexcept { return { this, position(key) }; }
+		iterator find(const Key& key) noexcept { return { this, position(key) }; }
+		const_iterator find(const Key& key) const noexcept { return { this, position(key) }; }
+
+		bool contains(std::string_view key) const noexcept { return position(key) != size(); }
+		bool contains(const Key& key) const noexcept { return position(key) != size(); }
+		size_t count(std::string_view key) const noexcept { return contains(key) ? 1 : 0; }
+
+		T& at(std::string_view key) {
+			const size_t found = position(key);
+			if (found == size()) throw std::out_of_range("Key not found: " + std::string(key));
+			return valueAt(found);
+		}
+		const T& at(std::string_view key) const {
+			return const_cast<BasicObject*>(this)->at(key);
+		}
+
+		T& at(const Key& key) {
+			const size_t found = position(key);
+			if (found == size()) throw std::out_of_range("Key not found: " + std::string(key.name()));
+			return valueAt(found);
+		}
+		const T& at(const Key& key) const {
+			return const_cast<BasicObject*>(this)->at(key);
+		}
+
+		// Appends a null member when key is missing
+		T& operator[](std::string_view key) {
+			return try_emplace(key).first->second;
+		}
+
+		T& operator[](const Key& key) {
+			const size_t found = position(key);
+			if (found != size()) return valueAt(found);
+			return valueAt(append(String(key.name(), resource())));
+		}
+
+		// Leaves key untouched when it is already present
+		template<typename... Args>
+		std::pair<iterator, bool> try_emplace(String&& key, Args&&... args) {
+			const size_t found = position(key);
+			if (found != size()) return { iterator(this, found), false };
+			return { iterator(this, append(std::move(key), std::forward<Args>(args)...)), true };
+		}
+
+		template<typename... Args>
+		std::pair<iterator, bool> try_emplace(std::string_view key, Args&&... args) {
+			const size_t found = position(key);
+			if (found != size()) return { iterator(this, found), false };
+			return { iterator(this, append(String(key, resource()), std::forward<Args>(args)...)), true };
+		}
+
+		template<typename K, typename V>
+		std::pair<iterator, bool> emplace(K&& key, V&& value) {
+			return try_emplace(String(std::string_view(key), resource()), std::forward<V>(value));
+		}
+
+		template<typename K, typename V>
+		std::pair<iterator, bool> emplace(const std::pair<K, V>& member) {
+			return emplace(member.first, member.second);
+		}
+
+		// Later members move down to keep the insertion order, the index marks the member's slot erased and lowers
+		// the positions after it instead of hashing every key again
+		size_t erase(std::string_view key) {
+			const size_t found = position(key);
+			if (found == size()) return 0;
+			detach();
+			const bool rebuild = m_index && unindexMember(found);
+			m_members.erase(m_members.begin() + found);
+			if (rebuild) fillIndex();
+			return 1;
+		}
+
+		// A shaped object stays shaped and keeps the capacity of its values
+		void clear() noexcept {
+			if (m_shaped) {
+				m_values.clear();
+				Shape::release(m_shape);
+				m_shape = nullptr;
+				return;
+			}
+			freeIndex();
+			m_members.clear();
+		}
+
+		// Equal members regardless of their order
+		friend bool operator==(const BasicObject& lhs, const BasicObject& rhs) {
+			if (lhs.size() != rhs.size()) return false;
+			return std::all_of(lhs.begin(), lhs.end(), [&rhs](const auto& member) {
+				auto it = rhs.find(member.first);
+				return it != rhs.end() && it->second == member.second;
+			});
+		}
+		friend bool operator!=(const BasicObject& lhs, const BasicObject& rhs) {
+			return !(lhs == rhs);
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,447 @@
+#pragma once
+#include <stdint.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <charconv>
+
+#include "JsonParser/Concepts.h"
+#include "JsonParser/Utils/Macros.h"
+#include "JsonParser/Utils/ScanUtils.h"
+#include "JsonParser/Utils/NumberParsing.h"
+#include "JsonParser/Utils/Escapes.h"
+
+namespace Json
+{
+	class OnDemandDocument;
+
+	// Cursor to a value in the raw input of an OnDemandDocument
+	// Nothing is parsed until a getter is called, unneeded values are skipped without being decoded
+	// Accepts the same syntax as ContainerParser (comments, trailing commas, leading '+')
+	class OnDemandValue
+	{
+	public:
+		enum class Type
+		{
+			Array,
+			Object,
+			String,
+			Bool,
+			Integer,
+			Number,
+			Null
+		};
+
+		class ArrayRange;
+		class ObjectRange;
+
+		static constexpr char beginArray = '[';
+		static constexpr char endArray = ']';
+		static constexpr char beginObject = '{';
+		static constexpr char endObject = '}';
+		static constexpr char nameSeparator = ':';
+		static constexpr char valueSeparator = ',';
+		static constexpr char stringStart = '\"';
+		static constexpr char stringEnd = '\"';
+		static constexpr char escapedCharStart = '\\';
+		static constexpr char decimalSeparator = '.';
+
+		static inline const std::string nullLiteral = "null";
+		static inline const std::string trueLiteral = "true";
+		static inline const std::string falseLiteral = "false";
+
+		static constexpr size_t npos = static_cast<size_t>(-1);
+
+	private:
+		const OnDemandDocument* m_document = nullptr;
+		size_t m_position = 0;
+
+		friend class OnDemandDocument;
+
+		OnDemandValue(const OnDemandDocument* document, size_t position) : m_document(document), m_position(position) {}
+
+		inline std::string_view input() const;
+
+		static inline bool isScalarEnd(char c) {
+			return Detail::isWhitespace(c) || c == valueSeparator || c == endArray || c == endObject || c == Detail::commentStart;
+		}
+
+		static inline size_t skipWhitespace(std::string_view input, size_t i) {
+			return Detail::skipWhitespace(input.data(), input.size(), i);
+		}
+
+		// i points at the opening quote, returns the index of the closing quote
+		static inline size_t findStringEnd(std::string_view input, size_t i, bool& hasEscapes) {
+			hasEscapes = false;
+			for (++i;; i += 2) {
+				i = Detail::findStringDelimiter(input.data(), input.size(), i);
+				if (i >= input.size()) throw std::runtime_error("Invalid string syntax");
+				if (input[i] == stringEnd) return i;
+				hasEscapes = true;
+			}
+		}
+
+		static inline size_t skipScalar(std::string_view input, size_t i) {
+			for (; i < input.size() && !isScalarEnd(input[i]); ++i);
+			return i;
+		}
+
+		static size_t skipContainer(std::string_view input, size_t i) {
+			size_t depth = 0;
+			bool hasEscapes;
+			while (true) {
+				i = Detail::findNestingChar(input.data(), input.size(), i);
+				if (i >= input.size()) throw std::runtime_error("Endless container");
+				switch (input[i]) {
+				case stringStart:
+					i = findStringEnd(input, i, hasEscapes) + 1;
+					break;
+				case Detail::commentStart:
+					i = Detail::skipCommentScalar(input.data(), input.size(), i) + 1;
+					break;
+				case beginArray:
+				case beginObject:
+					++depth;
+					++i;
+					break;
+				default:
+					++i;
+					if (--depth == 0) return i;
+					break;
+				}
+			}
+		}
+
+		// Returns the index just past the value starting at i
+		static inline size_t skipValue(std::string_view input, size_t i) {
+			bool hasEscapes;
+			switch (input[i]) {
+			case beginArray:
+			case beginObject:
+				return skipContainer(input, i);
+			case stringStart:
+				return findStringEnd(input, i, hasEscapes) + 1;
+			default:
+				return skipScalar(input, i);
+			}
+		}
+
+		// Given the index just past a value, returns the start of the next element/member or npos at the closing character
+		static inline size_t nextEntry(std::string_view input, size_t i, char close) {
+			i = skipWhitespace(input, i);
+			if (i >= input.size()) throw std::runtime_error(close == endArray ? "Endless array" : "Endless object");
+			if (input[i] == close) return npos;
+			if (input[i] != valueSeparator)
+				throw std::runtime_error(close == endArray ? "Expected ',' or ']'" : "Expected ',' or '}'");
+			i = skipWhitespace(input, i + 1);
+			if (i >= input.size()) throw std::runtime_error(close == endArray ? "Endless array" : "Endless object");
+			return input[i] == close ? npos : i;
+		}
+
+		static inline size_t firstEntry(std::string_view input, size_t i, char close) {
+			i = skipWhitespace(input, i + 1);
+			if (i >= input.size()) throw std::runtime_error(close == endArray ? "Endless array" : "Endless object");
+			return input[i] == close ? npos : i;
+		}
+
+		// i points at a key, returns the start of its value
+		static inline size_t memberValue(std::string_view input, size_t keyEnd) {
+			size_t i = skipWhitespace(input, keyEnd + 1);
+			if (i >= input.size() || input[i] != nameSeparator) throw std::runtime_error("Expected ':'");
+			i = skipWhitespace(input, i + 1);
+			if (i >= input.size()) throw std::runtime_error("Endless object");
+			return i;
+		}
+
+		// Decodes the string between the quotes at begin and end into string, replacing its content
+		static void decodeString(std::string_view input, size_t begin, size_t end, std::string& string) {
+			string.clear();
+			string.reserve(end - begin - 1);
+			size_t runStart = begin + 1;
+			for (size_t i = runStart; i < end; ++i) {
+				if (input[i] == escapedCharStart) {
+					string.append(&input[runStart], i - runStart);
+					Detail::decodeEscape(input.data(), input.size(), ++i, string);
+					runStart = i + 1;
+				}
+			}
+			string.append(&input[runStart], end - runStart);
+		}
+
+		// Compares a raw key with the given one, decoding only when the key contains escapes
+		static inline bool keyEquals(std::string_view input, size_t begin, size_t end, bool hasEscapes, std::string_view key) {
+			if (!hasEscapes) return input.substr(begin + 1, end - begin - 1) == key;
+			std::string decoded;
+			decodeString(input, begin, end, decoded);
+			return decoded == key;
+		}
+
+		inline size_t findMember(std::string_view key) const {
+			std::string_view in = input();
+			JSON_VERIFY(in[m_position] == beginObject, "Type mismatch");
+			bool hasEscapes;
+			for (size_t i = firstEntry(in, m_position, endObject); i != npos;) {
+				if (in[i] != stringStart) throw std::runtime_error("Expected string key");
+				size_t keyEnd = findStringEnd(in, i, hasEscapes);
+				size_t value = memberValue(in, keyEnd);
+				if (keyEquals(in, i, keyEnd, hasEscapes, key)) return value;
+				i = nextEntry(in, skipValue(in, value), endObject);
+			}
+			return npos;
+		}
+
+		inline std::string_view numberToken() const {
+			std::string_view in = input();
+			const char* last = in.data() + skipScalar(in, m_position);
+			const char* first = Detail::skipLeadingPlus(in.data() + m_position, last);
+			return std::string_view(first, last - first);
+		}
+
+	public:
+		OnDemandValue() = default;
+
+		Type getType() const {
+			std::string_view in = input();
+			switch (in[m_position]) {
+			case beginArray: return Type::Array;
+			case beginObject: return Type::Object;
+			case stringStart: return Type::String;
+			case 't': case 'f': return Type::Bool;
+			case 'n': return Type::Null;
+			default:
+				for (char c : in.substr(m_position, skipScalar(in, m_position) - m_position))
+					if (c == decimalSeparator || c == 'e' || c == 'E') return Type::Number;
+				return Type::Integer;
+			}
+		}
+
+		bool isNull() const { return getType() == Type::Null; }
+		bool isBool() const { return getType() == Type::Bool; }
+		bool isNumber() const { return getType() == Type::Number; }
+		bool isInteger() const { return getType() == Type::Integer; }
+		bool isString() const { return getType() == Type::String; }
+		bool isArray() const { return getType() == Type::Array; }
+		bool isObject() const { return getType() == Type::Object; }
+
+		bool getBool() const {
+			std::string_view in = input();
+			const std::string& literal = in[m_position] == 't' ? trueLiteral : falseLiteral;
+			if (in.compare(m_position, literal.size(), literal) != 0 || skipScalar(in, m_position) != m_position + literal.size())
+				throw std::runtime_error("Invalid bool literal");
+			return in[m_position] == 't';
+		}
+
+		int64_t getInt64() const {
+			JSON_VERIFY(isInteger(), "Type mismatch");
+			std::string_view token = numberToken();
+			int64_t integer = 0;
+			if (Detail::parseInteger(token.data(), token.data() + token.size(), integer) != Detail::IntegerStatus::Ok)
+				throw std::runtime_error("Invalid integer: " + std::string(token));
+			return integer;
+		}
+
+		// Accepts integers as well
+		double getDouble() const {
+			JSON_VERIFY(isNumber() || isInteger(), "Type mismatch");
+			std::string_view token = numberToken();
+			return Detail::parseDouble(token.data(), token.data() + token.size());
+		}
+
+		// Escape-free strings are returned as views into the input, escaped ones are decoded into buffer and the
+		// view is valid until buffer changes. Reading never changes the document, so threads may share it
+		std::string_view getString(std::string& buffer) const {
+			JSON_VERIFY(isString(), "Type mismatch");
+			std::string_view in = input();
+			bool hasEscapes;
+			size_t end = findStringEnd(in, m_position, hasEscapes);
+			if (!hasEscapes) return in.substr(m_position + 1, end - m_position - 1);
+			decodeString(in, m_position, end, buffer);
+			return buffer;
+		}
+
+		// The raw JSON text of this value
+		std::string_view getRaw() const {
+			std::string_view in = input();
+			return in.substr(m_position, skipValue(in, m_position) - m_position);
+		}
+
+		inline ArrayRange getArray() const;
+		inline ObjectRange getObject() const;
+
+		// Counts by skipping over every entry
+		size_t size() const {
+			std::string_view in = input();
+			char close = in[m_position] == beginArray ? endArray : endObject;
+			JSON_VERIFY(in[m_position] == beginArray || in[m_position] == beginObject, "Type mismatch");
+			bool hasEscapes;
+			size_t count = 0;
+			for (size_t i = firstEntry(in, m_position, close); i != npos; ++count) {
+				if (close == endObject) i = memberValue(in, findStringEnd(in, i, hasEscapes));
+				i = nextEntry(in, skipValue(in, i), close);
+			}
+			return count;
+		}
+
+		bool contains(std::string_view key) const {
+			return findMember(key) != npos;
+		}
+
+		// Scans the object from its start, iterate getObject() when reading many members
+		OnDemandValue operator[](std::string_view key) const {
+			size_t value = findMember(key);
+			if (value == npos) throw std::runtime_error("Key not found: " + std::string(key));
+			return OnDemandValue(m_document, value);
+		}
+
+		OnDemandValue operator[](size_t index) const {
+			std::string_view in = input();
+			JSON_VERIFY(in[m_position] == beginArray, "Type mismatch");
+			size_t i = firstEntry(in, m_position, endArray);
+			for (; i != npos && index > 0; --index)
+				i = nextEntry(in, skipValue(in, i), endArray);
+			if (i == npos) throw std::out_of_range("Array index out of range");
+			return OnDemandValue(m_document, i);
+		}
+	};
+
+	class OnDemandValue::ArrayRange
+	{
+	private:
+		const OnDemandDocument* m_document;
+		size_t m_begin;
+
+		friend class OnDemandValue;
+		ArrayRange(const OnDemandDocument* document, size_t begin) : m_document(document), m_begin(begin) {}
+
+	public:
+		class iterator
+		{
+		private:
+			const OnDemandDocument* m_document;
+			size_t m_position;
+
+		public:
+			using value_type = OnDemandValue;
+			using difference_type = std::ptrdiff_t;
+
+			iterator(const OnDemandDocument* document, size_t position) : m_document(document), m_position(position) {}
+
+			OnDemandValue operator*() const { return OnDemandValue(m_document, m_position); }
+			iterator& operator++() {
+				std::string_view in = OnDemandValue(m_document, m_position).input();
+				m_position = nextEntry(in, skipValue(in, m_position), endArray);
+				return *this;
+			}
+			bool operator==(const iterator& other) const { return m_position == other.m_position; }
+			bool operator!=(const iterator& other) const { return m_position != other.m_position; }
+		};
+
+		iterator begin() const { return iterator(m_document, m_begin); }
+		iterator end() const { return iterator(m_document, npos); }
+	};
+
+	class OnDemandValue::ObjectRange
+	{
+	private:
+		const OnDemandDocument* m_document;
+		size_t m_begin;
+
+		friend class OnDemandValue;
+		ObjectRange(const OnDemandDocument* document, size_t begin) : m_document(document), m_begin(begin) {}
+
+	public:
+		class iterator
+		{
+		private:
+			const OnDemandDocument* m_document;
+			size_t m_position;
+			size_t m_keyEnd = 0;
+			size_t m_value = 0;
+			bool m_hasEscapes = false;
+			// The current key if it has escapes
+			std::string m_decodedKey;
+
+			void load() {
+				if (m_position == npos) return;
+				std::string_view in = OnDemandValue(m_document, m_position).input();
+				if (in[m_position] != stringStart) throw std::runtime_error("Expected string key");
+				m_keyEnd = findStringEnd(in, m_position, m_hasEscapes);
+				if (m_hasEscapes) decodeString(in, m_position, m_keyEnd, m_decodedKey);
+				m_value = memberValue(in, m_keyEnd);
+			}
+
+		public:
+			using value_type = std::pair<std::string_view, OnDemandValue>;
+			using difference_type = std::ptrdiff_t;
+
+			iterator(const OnDemandDocument* document, size_t position) : m_document(document), m_position(position) { load(); }
+
+			// A key with escapes is a view into the iterator, valid until it is incremented
+			value_type operator*() const {
+				std::string_view name = m_hasEscapes
+					? std::string_view(m_decodedKey)
+					: OnDemandValue(m_document, m_position).input().substr(m_position + 1, m_keyEnd - m_position - 1);
+				return { name, OnDemandValue(m_document, m_value) };
+			}
+			iterator& operator++() {
+				std::string_view in = OnDemandValue(m_document, m_position).input();
+				m_position = nextEntry(in, skipValue(in, m_value), endObject);
+				load();
+				return *this;
+			}
+			bool operator==(const iterator& other) const { return m_position == other.m_position; }
+			bool operator!=(const iterator& other) const { return m_position != other.m_position; }
+		};
+
+		iterator begin() const { return iterator(m_document, m_begin); }
+		iterator end() const { return iterator(m_document, npos); }
+	};
+
+	// Lazily parsed view over a caller-owned buffer (std::string_view, MappedFile, std::string...)
+	// The buffer must outlive the document and every value obtained from it
+	class OnDemandDocument
+	{
+	private:
+		std::string_view m_input;
+
+		friend class OnDemandValue;
+
+	public:
+		explicit OnDemandDocument(std::string_view input) : m_input(input) {}
+
+		template<Container C>
+		explicit OnDemandDocument(const C& input)
+			: m_input(input.size() ? std::string_view(&input[0], input.size()) : std::string_view()) {}
+
+		OnDemandDocument(std::string&&) = delete;
+
+		OnDemandDocument(const OnDemandDocument&) = delete;
+		OnDemandDocument& operator=(const OnDemandDocument&) = delete;
+
+		OnDemandValue root() const {
+			size_t i = Detail::skipWhitespace(m_input.data(), m_input.size(), 0);
+			if (i >= m_input.size()) throw std::runtime_error("Empty document");
+			return OnDemandValue(this, i);
+		}
+
+		OnDemandValue operator[](std::string_view key) const { return root()[key]; }
+		OnDemandValue operator[](size_t index) const { return root()[index]; }
+	};
+
+	inline std::string_view OnDemandValue::input() const {
+		return m_document->m_input;
+	}
+
+	inline OnDemandValue::ArrayRange OnDemandValue::getArray() const {
+		std::string_view in = input();
+		JSON_VERIFY(in[m_position] == beginArray, "Type mismatch");
+		return ArrayRange(m_document, firstEntry(in, m_position, endArray));
+	}
+
+	inline OnDemandValue::ObjectRange OnDemandValue::getObject() const {
+		std::string_view in = input();
+		JSON_VERIFY(in[m_position] == beginObject, "Type mismatch");
+		return ObjectRange(m_document, firstEntry(in, m_position, endObject));
+	}
+}
\ No newline at end of file
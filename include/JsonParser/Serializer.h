@@ -0,0 +1,197 @@
+#pragma once
+#include <stdint.h>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "JsonParser/Concepts.h"
+#include "JsonParser/String.h"
+#include "JsonParser/Utils/NumberFormatting.h"
+#include "JsonParser/Utils/ScanUtils.h"
+
+namespace Json
+{
+	namespace Detail
+	{
+		// Appends value with '"', '\\' and the control characters escaped, using the short forms where JSON has one
+		// Runs without any are found with the SIMD kernels and appended in bulk
+		template<OutputBuffer Output>
+		void appendEscaped(Output& output, std::string_view value) {
+			static constexpr char hexDigits[] = "0123456789abcdef";
+			const char* data = value.data();
+			const size_t size = value.size();
+			size_t runStart = 0;
+			while (true) {
+				const size_t end = findEscapeChar(data, size, runStart);
+				output.append(std::string_view(data + runStart, end - runStart));
+				if (end == size) return;
+				const unsigned char c = static_cast<unsigned char>(data[end]);
+				switch (c) {
+				case '"': output.append("\\\""); break;
+				case '\\': output.append("\\\\"); break;
+				case '\b': output.append("\\b"); break;
+				case '\f': output.append("\\f"); break;
+				case '\n': output.append("\\n"); break;
+				case '\r': output.append("\\r"); break;
+				case '\t': output.append("\\t"); break;
+				default: {
+					const char escape[] = { '\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0xF] };
+					output.append(std::string_view(escape, sizeof(escape)));
+				}
+				}
+				runStart = end + 1;
+			}
+		}
+	}
+
+	// Writes the JSON text of a Value in a single walk of the tree, appending to one output string that the
+	// caller may reuse, so the only allocations are the output growing
+	// Output can also be a ChunkedOutput streaming the text to a Sink (file descriptor, ostream, callback)
+	// through a fixed buffer, which is all the memory writing takes then
+	// Compact unless indent is set, which puts every element and member on a line of its own, indented by indent
+	// spaces per level of nesting and margin more
+	// Packed and columnar arrays are written as they are stored, without unpacking them
+	template<typename Value, OutputBuffer Output = std::string>
+	class Serializer
+	{
+	private:
+		using Type = typename Value::Type;
+
+		Output& m_output;
+		size_t m_indent;
+		// Spaces before the current line
+		size_t m_depth;
+
+		inline void newLine() {
+			if (!m_indent) return;
+			m_output.push_back('\n');
+			m_output.append(m_depth, ' ');
+		}
+
+		inline void open(char bracket) {
+			m_output.push_back(bracket);
+			m_depth += m_indent;
+		}
+
+		// empty when nothing was written since open
+		inline void close(char bracket, bool empty) {
+			m_depth -= m_indent;
+			if (!empty) newLine();
+			m_output.push_back(bracket);
+		}
+
+		inline void writeString(std::string_view value, bool escapeFree) {
+			m_output.push_back('"');
+			if (escapeFree) m_output.append(value);
+			else Detail::appendEscaped(m_output, value);
+			m_output.push_back('"');
+		}
+
+		inline void writeString(const String& value) { writeString(value.view(), value.isEscapeFree()); }
+
+		inline void writeKey(const String& key) {
+			writeString(key);
+			m_output.push_back(':');
+			if (m_indent) m_output.push_back(' ');
+		}
+
+		inline void writeNumber(int64_t value) {
+			char buffer[Detail::maxIntegerChars];
+			m_output.append(std::string_view(buffer, Detail::formatInteger(value, buffer) - buffer));
+		}
+
+		// Shortest round trip, NaN and infinities as null
+		inline void writeNumber(double value) {
+			char buffer[Detail::maxNumberChars];
+			m_output.append(std::string_view(buffer, Detail::formatNumber(value, buffer) - buffer));
+		}
+
+		template<typename T>
+		void writeElements(const T& elements) {
+			open('[');
+			bool first = true;
+			for (const auto& element : elements) {
+				if (!first) m_output.push_back(',');
+				first = false;
+				newLine();
+				write(element);
+			}
+			close(']', first);
+		}
+
+		// Each row of a columnar array as an object of the table's keys
+		template<typename Table>
+		void writeRows(const Table& table) {
+			open('[');
+			for (size_t row = 0; row < table.rows; ++row) {
+				if (row) m_output.push_back(',');
+				newLine();
+				open('{');
+				for (size_t i = 0; i < table.keys.size(); ++i) {
+					if (i) m_output.push_back(',');
+					newLine();
+					writeKey(table.keys[i]);
+					const Value& column = table.columns[i];
+					if (column.isIntegerArray()) writeNumber(column.asIntegerSpan()[row]);
+					else if (column.isNumberArray()) writeNumber(column.asNumberSpan()[row]);
+					else write(column.asArray()[row]);
+				}
+				close('}', table.keys.empty());
+			}
+			close(']', table.rows == 0);
+		}
+
+		void writeObject(const typename Value::Object& object) {
+			open('{');
+			bool first = true;
+			for (auto&& [key, value] : object) {
+				if (!first) m_output.push_back(',');
+				first = false;
+				newLine();
+				writeKey(key);
+				write(value);
+			}
+			close('}', first);
+		}
+
+	public:
+		explicit Serializer(Output& output, size_t indent = 0, size_t margin = 0) noexcept
+			: m_output(output), m_indent(indent), m_depth(margin) {}
+
+		void write(const Value& value) {
+			switch (value.getType()) {
+			case Type::Array:
+				if (value.isIntegerArray()) writeElements(value.asIntegerSpan());
+				else if (value.isNumberArray()) writeElements(value.asNumberSpan());
+				else if (value.isColumnar()) writeRows(*value.m_cell.table);
+				else writeElements(value.asArray());
+				break;
+			case Type::Object:
+				writeObject(value.asObject());
+				break;
+			case Type::String:
+				if (value.tag() == Value::boxedStringTag) writeString(value.asStringView(), false);
+				else writeString(value.m_string);
+				break;
+			case Type::Bool:
+				m_output.append(value.asBool() ? "true" : "false");
+				break;
+			case Type::Integer:
+				writeNumber(value.asInteger());
+				break;
+			case Type::Number:
+				writeNumber(value.asNumber());
+				break;
+			case Type::Null:
+				m_output.append("null");
+				break;
+			default:
+				throw std::runtime_error("Unknown type");
+			}
+		}
+
+		inline void write(int64_t value) { writeNumber(value); }
+		inline void write(double value) { writeNumber(value); }
+	};
+}
\ No newline at end of file
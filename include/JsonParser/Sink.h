@@ -0,0 +1,145 @@
+#pragma once
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "JsonParser/Concepts.h"
+
+namespace Json
+{
+	// Writes to a file descriptor (a file, pipe or socket) it does not own
+	class FileSink
+	{
+	private:
+		int m_fd;
+
+	public:
+		explicit FileSink(int fd) noexcept : m_fd(fd) {}
+
+		void write(const char* data, size_t size) {
+			while (size) {
+#ifdef _WIN32
+				const unsigned int count = size < 0x40000000 ? static_cast<unsigned int>(size) : 0x40000000;
+				const int written = ::_write(m_fd, data, count);
+#else
+				const ssize_t written = ::write(m_fd, data, size);
+#endif
+				if (written < 0) {
+					if (errno == EINTR) continue;
+					throw std::system_error(errno, std::generic_category(), "Failed to write JSON output");
+				}
+				data += written;
+				size -= static_cast<size_t>(written);
+			}
+		}
+	};
+
+	// Writes to the buffer of a std::ostream through sputn, bypassing the stream's formatting
+	class StreamSink
+	{
+	private:
+		std::ostream& m_stream;
+
+	public:
+		explicit StreamSink(std::ostream& stream) noexcept : m_stream(stream) {}
+
+		void write(const char* data, size_t size) {
+			std::streambuf* buffer = m_stream.rdbuf();
+			if (!buffer || buffer->sputn(data, static_cast<std::streamsize>(size)) != static_cast<std::streamsize>(size)) {
+				m_stream.setstate(std::ios::badbit);
+				throw std::runtime_error("Failed to write JSON output");
+			}
+		}
+	};
+
+	// Passes every chunk to callback as a std::string_view, valid for the duration of the call
+	template<typename Callback>
+	class CallbackSink
+	{
+	private:
+		Callback m_callback;
+
+	public:
+		explicit CallbackSink(Callback callback) : m_callback(std::move(callback)) {}
+
+		void write(const char* data, size_t size) { m_callback(std::string_view(data, size)); }
+	};
+
+	// OutputBuffer for Serializer that collects the text in a fixed buffer and passes it on to a Sink whenever it is
+	// full, so serializing takes capacity bytes however large the output. Pieces larger than the buffer (long strings)
+	// go to the sink without being copied
+	// Either allocates its buffer once or uses one of the caller's, which has to outlive it
+	// Call flush at the end: the destructor drops what is still buffered, it cannot report a failing sink
+	template<Sink S>
+	class ChunkedOutput
+	{
+	public:
+		static constexpr size_t defaultCapacity = 64 * 1024;
+
+	private:
+		S& m_sink;
+		std::unique_ptr<char[]> m_owned;
+		char* m_buffer;
+		size_t m_capacity;
+		size_t m_size = 0;
+
+	public:
+		explicit ChunkedOutput(S& sink, size_t capacity = defaultCapacity)
+			: m_sink(sink), m_owned(new char[capacity ? capacity : 1]), m_buffer(m_owned.get()), m_capacity(capacity ? capacity : 1) {}
+		ChunkedOutput(S& sink, char* buffer, size_t capacity)
+			: m_sink(sink), m_buffer(buffer), m_capacity(capacity) {
+			if (!buffer || !capacity) throw std::invalid_argument("ChunkedOutput needs a buffer");
+		}
+
+		ChunkedOutput(const ChunkedOutput&) = delete;
+		ChunkedOutput& operator=(const ChunkedOutput&) = delete;
+
+		inline void push_back(char c) {
+			if (m_size == m_capacity) flush();
+			m_buffer[m_size++] = c;
+		}
+
+		inline void append(std::string_view text) {
+			if (text.size() > m_capacity - m_size) {
+				flush();
+				if (text.size() >= m_capacity) {
+					m_sink.write(text.data(), text.size());
+					return;
+				}
+			}
+			std::memcpy(m_buffer + m_size, text.data(), text.size());
+			m_size += text.size();
+		}
+
+		void append(size_t count, char c) {
+			while (count) {
+				if (m_size == m_capacity) flush();
+				const size_t fill = count < m_capacity - m_size ? count : m_capacity - m_size;
+				std::memset(m_buffer + m_size, c, fill);
+				m_size += fill;
+				count -= fill;
+			}
+		}
+
+		// Passes everything buffered on to the sink
+		void flush() {
+			if (!m_size) return;
+			m_sink.write(m_buffer, m_size);
+			m_size = 0;
+		}
+
+		size_t capacity() const noexcept { return m_capacity; }
+	};
+}
\ No newline at end of file
@@ -8,7 +8,10 @@
 #include <fstream>
 
 #include "JsonParser/Utils/SIMDUtils.h"
+#include "JsonParser/Utils/NumberParsing.h"
+#include "JsonParser/Utils/Escapes.h"
 #include "JsonParser/Concepts.h"
+#include "JsonParser/ValueBuilder.h"
 
 namespace Json
 {
@@ -45,36 +48,10 @@ namespace Json
 		static inline void handleEscapedChar(S& input, char& currentChar, std::string& string)
 		{
 			if (!input.get(currentChar)) throw std::runtime_error("Unterminated escape sequence");
-			switch (currentChar) {
-			case '"':  string.push_back('"'); break;
-			case '\\': string.push_back('\\'); break;
-			case '/':  string.push_back('/'); break;
-			case 'b':  string.push_back('\b'); break;
-			case 'f':  string.push_back('\f'); break;
-			case 'n':  string.push_back('\n'); break;
-			case 'r':  string.push_back('\r'); break;
-			case 't':  string.push_back('\t'); break;
-			case 'u': {
-				std::string hex(4, '\0');
-				for (int i = 0; i < 4; ++i) {
-					if (!input.get(hex[i])) throw std::runtime_error("Invalid unicode escape");
-				}
-				unsigned int codepoint = std::stoul(hex, nullptr, 16);
-				if (codepoint <= 0x7F) {
-					string.push_back(static_cast<char>(codepoint));
-				} else if (codepoint <= 0x7FF) {
-					string.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
-					string.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
-				} else {
-					string.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
-					string.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
-					string.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
-				}
-				break;
-			}
-			default:
-				throw std::runtime_error(std::string("Invalid escape sequence: \\") + currentChar);
-			}
+			Detail::decodeEscape(currentChar, [&input, &currentChar] {
+				if (!input.get(currentChar)) throw std::runtime_error("Invalid unicode escape");
+				return currentChar;
+			}, string);
 		}
 
 		template<Stream S>
@@ -113,23 +90,20 @@ namespace Json
 			}
 		}
 
-		template<Stream S>
-		static inline Value parseNumber(S& input, char& currentChar) {
-			std::string string;
+		template<Stream S, Handler H>
+		static inline void parseNumber(S& input, char& currentChar, H& handler) {
+			Detail::NumberBuffer buffer;
 			bool isFloat = false;
 			
 			do {
-				string.push_back(currentChar);
+				buffer.push(currentChar);
 				if (currentChar == decimalSeparator || currentChar == 'e' || currentChar == 'E') isFloat = true;
 				if (!input.get(currentChar)) break;
 			} while ((currentChar >= '0' && currentChar <= '9') || currentChar == '+' || currentChar == '-' || 
 					 currentChar == 'e' || currentChar == 'E' || currentChar == decimalSeparator);
 			
-			if (isFloat) {
-				return Value(std::stod(string));
-			} else {
-				return Value(std::stoi(string));
-			}
+			const char* last = buffer.data() + buffer.size();
+			Detail::parseNumber(Detail::skipLeadingPlus(buffer.data(), last), last, isFloat, handler);
 		}
 
 		template<Stream S>
@@ -149,32 +123,32 @@ namespace Json
 		}
 
 		template<Stream S>
-		static inline Value parseLiteral(S& input, char& currentChar, const std::string& literal, Value value) {
+		static inline void parseLiteral(S& input, char& currentChar, const std::string& literal) {
 			for (size_t i = 1; i < literal.size(); ++i) {
 				if (!input.get(currentChar) || currentChar != literal[i]) {
 					throw std::runtime_error("Invalid " + literal + " literal");
 				}
 			}
 			input.get(currentChar);
-			return value;
 		}
 
-		template<Stream S>
-		static Value parseArray(S& input, char& currentChar) {
-			Value value = Value::array();
-			auto& array = value.asArray();
+		template<Stream S, Handler H>
+		static void parseArray(S& input, char& currentChar, H& handler) {
+			handler.onStartArray();
 			while (true) {
 				input.get(currentChar);
 				skipWhitespace(input, currentChar);
 				if (currentChar == endArray) {
 					input.get(currentChar);
-					return value;
+					handler.onEndArray();
+					return;
 				}
-				array.emplace_back(parseValue(input, currentChar));
+				parseValue(input, currentChar, handler);
 				skipWhitespace(input, currentChar);
 				if (currentChar == endArray) {
 					input.get(currentChar);
-					return value;
+					handler.onEndArray();
+					return;
 				} else if (currentChar == valueSeparator) {
 					continue;
 				} else {
@@ -183,28 +157,29 @@ namespace Json
 			}
 		}
 
-		template<Stream S>
-		static Value parseObject(S& input, char& currentChar) {
-			Value value = Value::object();
-			auto& object = value.asObject();
+		template<Stream S, Handler H>
+		static void parseObject(S& input, char& currentChar, H& handler) {
+			handler.onStartObject();
 			while (true) {
 				input.get(currentChar);
 				skipWhitespace(input, currentChar);
 				if (currentChar == endObject) {
 					input.get(currentChar);
-					return value;
+					handler.onEndObject();
+					return;
 				}
 				if (currentChar != stringStart) throw std::runtime_error("Expected string key");
-				std::string key = parseString(input, currentChar);
+				handler.onKey(parseString(input, currentChar));
 				skipWhitespace(input, currentChar);
 				if (currentChar != nameSeparator) throw std::runtime_error("Expected ':'");
 				input.get(currentChar);
 				skipWhitespace(input, currentChar);
-				object[key] = parseValue(input, currentChar);
+				parseValue(input, currentChar, handler);
 				skipWhitespace(input, currentChar);
 				if (currentChar == endObject) {
 					input.get(currentChar);
-					return value;
+					handler.onEndObject();
+					return;
 				} else if (currentChar == valueSeparator) {
 					continue;
 				} else {
@@ -213,38 +188,45 @@ namespace Json
 			}
 		}
 
-		template<Stream S>
-		static Value parseValue(S& input, char& currentChar) {
+		template<Stream S, Handler H>
+		static void parseValue(S& input, char& currentChar, H& handler) {
 			switch (currentChar) {
-			case beginObject: return parseObject(input, currentChar);
-			case beginArray: return parseArray(input, currentChar);
-			case stringStart: return Value(parseString(input, currentChar));
-			case 't': return parseLiteral(input, currentChar, trueLiteral, Value(true));
-			case 'f': return parseLiteral(input, currentChar, falseLiteral, Value(false));
-			case 'n': return parseLiteral(input, currentChar, nullLiteral, Value(nullptr));
+			case beginObject: parseObject(input, currentChar, handler); return;
+			case beginArray: parseArray(input, currentChar, handler); return;
+			case stringStart: handler.onString(parseString(input, currentChar)); return;
+			case 't': parseLiteral(input, currentChar, trueLiteral); handler.onBool(true); return;
+			case 'f': parseLiteral(input, currentChar, falseLiteral); handler.onBool(false); return;
+			case 'n': parseLiteral(input, currentChar, nullLiteral); handler.onNull(); return;
 			default:
 				if ((currentChar >= '0' && currentChar <= '9') || currentChar == '+' || currentChar == '-') {
-					return parseNumber(input, currentChar);
+					parseNumber(input, currentChar, handler);
+					return;
 				}
 				throw std::runtime_error(std::string("Invalid value: ") + currentChar);
 			}
 		}
 
 	public:
-		template<Stream S>
-		static std::vector<Value> parse(S& input) {
-			std::vector<Value> document;
+		// Reports every root value in the stream to the handler as a stream of events
+		template<Stream S, Handler H>
+		static void parse(S& input, H& handler) {
 			char currentChar;
 			try {
 				while (input.get(currentChar)) {
 					skipWhitespace(input, currentChar);
 					if (input.eof()) break;
-					document.push_back(parseValue(input, currentChar));
+					parseValue(input, currentChar, handler);
 				}
 			} catch (const std::exception& e) {
 				throw std::runtime_error(std::string("JSON parsing failed: ") + e.what());
 			}
-			return document;
+		}
+
+		template<Stream S>
+		static std::vector<Value> parse(S& input) {
+			ValueBuilder<Value> builder;
+			parse(input, builder);
+			return builder.release();
 		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,276 @@
+#pragma once
+#include <stdint.h>
+#include <cstring>
+#include <atomic>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <compare>
+#include <functional>
+#include <memory_resource>
+
+namespace Json
+{
+	// Characters of a string Value or object key, 16 bytes in four forms:
+	//   inline    up to 14 characters stored in the String itself
+	//   shared    reference counted, immutable heap buffer shared by all copies of the String, which also caches
+	//             the hash of the characters (see InternPool)
+	//   resource  buffer of its own allocated from a memory_resource, which has to outlive the String
+	//   borrowed  view into a buffer that outlives the String, created by Document for escape-free
+	//             strings in its input, which the Document keeps alive
+	// Copies never borrow and copy resource buffers to the heap, so a copied Value does not refer to another
+	// document's input or to a resource it may outlive
+	// Strings of up to inlineCapacity characters are always inline, with every unused byte zero, so two Strings
+	// one of which is inline are equal exactly when their 16 bytes are
+	//
+	// Byte layout: 15 is the control byte (inlineBit | length for inline strings, otherwise sharedBit, resourceBit or 0)
+	// 0..7 the data pointer, 8..13 the length as 32 + 16 bits, 14 flags (escapeFreeBit), always 0 for inline strings
+	// Control bytes from reservedTags to reservedTags + 0x1F never occur, Value uses them to tag its other types
+	class String
+	{
+	public:
+		static constexpr size_t inlineCapacity = 14;
+		static constexpr uint8_t reservedTags = 0x20;
+
+	private:
+		static constexpr uint8_t inlineBit = 0x80;
+		static constexpr uint8_t sharedBit = 0x40;
+		static constexpr uint8_t resourceBit = 0x10;
+		static constexpr uint8_t lengthMask = 0x0F;
+		static constexpr uint8_t escapeFreeBit = 0x01;
+
+		// Precedes the characters of a shared String
+		struct SharedHeader {
+			std::atomic<uint32_t> references = 1;
+			// 0 until first asked for
+			std::atomic<size_t> hash = 0;
+		};
+
+		// Precedes the characters of a resource String
+		struct ResourceHeader {
+			std::pmr::memory_resource* resource;
+		};
+
+		alignas(8) char m_bytes[16] = {};
+
+		inline uint8_t control() const noexcept { return static_cast<uint8_t>(m_bytes[15]); }
+
+		inline const char* externalData() const noexcept {
+			const char* data;
+			std::memcpy(&data, m_bytes, sizeof(data));
+			return data;
+		}
+
+		inline size_t externalSize() const noexcept {
+			uint32_t low;
+			uint16_t high;
+			std::memcpy(&low, m_bytes + 8, sizeof(low));
+			std::memcpy(&high, m_bytes + 12, sizeof(high));
+			return static_cast<size_t>(low | (static_cast<uint64_t>(high) << 32));
+		}
+
+		inline void setExternal(const char* data, size_t size, uint8_t control) noexcept {
+			const uint32_t low = static_cast<uint32_t>(size);
+			const uint16_t high = static_cast<uint16_t>(static_cast<uint64_t>(size) >> 32);
+			std::memcpy(m_bytes, &data, sizeof(data));
+			std::memcpy(m_bytes + 8, &low, sizeof(low));
+			std::memcpy(m_bytes + 12, &high, sizeof(high));
+			m_bytes[14] = 0;
+			m_bytes[15] = static_cast<char>(control);
+		}
+
+		inline void setInline(std::string_view value) noexcept {
+			std::memcpy(m_bytes, value.data(), value.size());
+			m_bytes[15] = static_cast<char>(inlineBit | value.size());
+		}
+
+		inline SharedHeader* sharedHeader() const noexcept {
+			return reinterpret_cast<SharedHeader*>(const_cast<char*>(externalData()) - sizeof(SharedHeader));
+		}
+
+		inline void assign(std::string_view value) {
+			if (value.size() <= inlineCapacity) {
+				setInline(value);
+				return;
+			}
+			char* buffer = new char[sizeof(SharedHeader) + value.size()];
+			new (buffer) SharedHeader();
+			std::memcpy(buffer + sizeof(SharedHeader), value.data(), value.size());
+			setExternal(buffer + sizeof(SharedHeader), value.size(), sharedBit);
+		}
+
+		inline void assign(std::string_view value, std::pmr::memory_resource* resource) {
+			if (!resource || value.size() <= inlineCapacity) {
+				assign(value);
+				return;
+			}
+			char* buffer = static_cast<char*>(resource->allocate(sizeof(ResourceHeader) + value.size(), alignof(ResourceHeader)));
+			new (buffer) ResourceHeader{ resource };
+			std::memcpy(buffer + sizeof(ResourceHeader), value.data(), value.size());
+			setExternal(buffer + sizeof(ResourceHeader), value.size(), resourceBit);
+		}
+
+		inline void free() noexcept {
+			if (isShared()) {
+				SharedHeader* header = sharedHeader();
+				if (header->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+					header->~SharedHeader();
+					delete[] reinterpret_cast<char*>(header);
+				}
+			}
+			else if (control() == resourceBit) {
+				char* buffer = const_cast<char*>(externalData()) - sizeof(ResourceHeader);
+				std::pmr::memory_resource* resource = reinterpret_cast<ResourceHeader*>(buffer)->resource;
+				resource->deallocate(buffer, sizeof(ResourceHeader) + externalSize(), alignof(ResourceHeader));
+			}
+		}
+
+		inline void release() noexcept {
+			free();
+			std::memset(m_bytes, 0, sizeof(m_bytes));
+			m_bytes[15] = static_cast<char>(inlineBit);
+		}
+
+		// Keeps the flags of an out-of-line copy of other
+		inline void copyFlags(const String& other) noexcept {
+			if (!isInline()) m_bytes[14] = other.m_bytes[14];
+		}
+
+		inline void share(const String& other) noexcept {
+			other.sharedHeader()->references.fetch_add(1, std::memory_order_relaxed);
+			std::memcpy(m_bytes, other.m_bytes, sizeof(m_bytes));
+		}
+
+		inline void steal(String& other) noexcept {
+			std::memcpy(m_bytes, other.m_bytes, sizeof(m_bytes));
+			std::memset(other.m_bytes, 0, sizeof(other.m_bytes));
+			other.m_bytes[15] = static_cast<char>(inlineBit);
+		}
+
+	public:
+		String() noexcept { m_bytes[15] = static_cast<char>(inlineBit); }
+		String(std::string_view value) { assign(value); }
+		String(const std::string& value) { assign(value); }
+		String(const char* value) { assign(value); }
+		// Allocates from resource unless it is nullptr or value is inline
+		String(std::string_view value, std::pmr::memory_resource* resource) { assign(value, resource); }
+		// A copy allocating from resource, which shares other's buffer only when both are on the heap
+		String(const String& other, std::pmr::memory_resource* resource) {
+			if (resource || !other.isShared()) {
+				assign(other.view(), resource);
+				copyFlags(other);
+			}
+			else share(other);
+		}
+
+		// The caller guarantees value stays alive and unchanged for the lifetime of the String
+		// Short values are copied inline anyway
+		static String borrow(std::string_view value) noexcept {
+			String string;
+			if (value.size() <= inlineCapacity) string.setInline(value);
+			else string.setExternal(value.data(), value.size(), 0);
+			return string;
+		}
+
+		// Borrows the same buffer when this String is borrowed and copies it otherwise,
+		// for copies that live no longer than the original's buffer (within one Document)
+		String borrowOrCopy() const {
+			if (!isBorrowed()) return String(*this);
+			return borrowed();
+		}
+
+		// Borrows this String's buffer whatever its form, for a copy that lives no longer than this String
+		String borrowed() const noexcept {
+			String string = borrow(view());
+			string.copyFlags(*this);
+			return string;
+		}
+
+		~String() {
+			free();
+		}
+
+		String(const String& other) {
+			if (other.isShared()) share(other);
+			else {
+				assign(other.view());
+				copyFlags(other);
+			}
+		}
+		String& operator=(const String& other) {
+			if (this != &other) {
+				String copy(other);
+				release();
+				steal(copy);
+			}
+			return *this;
+		}
+
+		String(String&& other) noexcept { steal(other); }
+		String& operator=(String&& other) noexcept {
+			if (this != &other) {
+				release();
+				steal(other);
+			}
+			return *this;
+		}
+
+		bool isInline() const noexcept { return (control() & inlineBit) != 0; }
+		bool isShared() const noexcept { return control() == sharedBit; }
+		bool isBorrowed() const noexcept { return control() == 0; }
+
+		// Set for out-of-line strings known to contain no character JSON has to escape ('"', '\' or a control
+		// character), such as the escape-free strings of the parsers' input, so that Serializer copies them as
+		// they are. Inline strings never keep the mark, they are short enough to check
+		bool isEscapeFree() const noexcept { return (m_bytes[14] & escapeFreeBit) != 0; }
+		void markEscapeFree() noexcept {
+			if (!isInline()) m_bytes[14] |= escapeFreeBit;
+		}
+
+		const char* data() const noexcept { return isInline() ? m_bytes : externalData(); }
+		size_t size() const noexcept { return isInline() ? (control() & lengthMask) : externalSize(); }
+		bool empty() const noexcept { return size() == 0; }
+		const char* begin() const noexcept { return data(); }
+		const char* end() const noexcept { return data() + size(); }
+
+		std::string_view view() const noexcept { return isInline() ? std::string_view(m_bytes, control() & lengthMask) : std::string_view(externalData(), externalSize()); }
+		operator std::string_view() const noexcept { return view(); }
+		std::string str() const { return std::string(view()); }
+
+		// The 16 bytes compared by key lookups
+		const char* bytes() const noexcept { return m_bytes; }
+
+		// std::hash of the characters, computed once for shared Strings
+		size_t hash() const noexcept {
+			if (!isShared()) return std::hash<std::string_view>{}(view());
+			SharedHeader* header = sharedHeader();
+			size_t hash = header->hash.load(std::memory_order_relaxed);
+			if (hash == 0) {
+				hash = std::hash<std::string_view>{}(view());
+				header->hash.store(hash, std::memory_order_relaxed);
+			}
+			return hash;
+		}
+
+		// Strings sharing a buffer (copies, interned strings, see InternPool) compare by pointer
+		friend bool operator==(const String& lhs, const String& rhs) noexcept {
+			if (lhs.isInline() || rhs.isInline()) return std::memcmp(lhs.m_bytes, rhs.m_bytes, sizeof(m_bytes)) == 0;
+			if (lhs.externalSize() != rhs.externalSize()) return false;
+			return lhs.externalData() == rhs.externalData() || std::memcmp(lhs.externalData(), rhs.externalData(), lhs.externalSize()) == 0;
+		}
+		friend bool operator==(const String& lhs, std::string_view rhs) noexcept { return lhs.view() == rhs; }
+		friend bool operator==(const String& lhs, const char* rhs) noexcept { return lhs.view() == rhs; }
+		friend std::strong_ordering operator<=>(const String& lhs, const String& rhs) noexcept { return lhs.view() <=> rhs.view(); }
+		friend std::strong_ordering operator<=>(const String& lhs, std::string_view rhs) noexcept { return lhs.view() <=> rhs; }
+		friend std::strong_ordering operator<=>(const String& lhs, const char* rhs) noexcept { return lhs.view() <=> rhs; }
+	};
+}
+
+template<>
+struct std::hash<Json::String>
+{
+	size_t operator()(const Json::String& string) const noexcept {
+		return string.hash();
+	}
+};
\ No newline at end of file
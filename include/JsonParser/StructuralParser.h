@@ -0,0 +1,217 @@
+#pragma once
+#include <stdint.h>
+#include <array>
+#include <stdexcept>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <charconv>
+
+#include "JsonParser/Utils/SIMDUtils.h"
+#include "JsonParser/Utils/StructuralIndexer.h"
+#include "JsonParser/Utils/ScanUtils.h"
+#include "JsonParser/Utils/NumberParsing.h"
+#include "JsonParser/Utils/Escapes.h"
+#include "JsonParser/Concepts.h"
+#include "JsonParser/ValueBuilder.h"
+
+namespace Json
+{
+	// Two-stage parser for RFC 7159/8259 input held in contiguous memory, no comments or trailing commas
+	// Stage 1 builds a structural index with SIMD, stage 2 walks the index and reports values to a handler
+
+	template<typename Value>
+	class StructuralParser
+	{
+	public:
+		static constexpr char beginArray = '[';
+		static constexpr char endArray = ']';
+		static constexpr char beginObject = '{';
+		static constexpr char endObject = '}';
+		static constexpr char nameSeparator = ':';
+		static constexpr char valueSeparator = ',';
+		static constexpr char stringStart = '\"';
+		static constexpr char stringEnd = '\"';
+		static constexpr char escapedCharStart = '\\';
+		static constexpr char decimalSeparator = '.';
+
+		static inline const std::string nullLiteral = "null";
+		static inline const std::string trueLiteral = "true";
+		static inline const std::string falseLiteral = "false";
+
+	private:
+		using Index = Detail::StructuralIndex;
+
+		// Character at the i-th structural position, the sentinel reads as '\0'
+		static inline char peek(std::string_view input, const Index& index, size_t i) {
+			size_t position = index[i];
+			return position < input.size() ? input[position] : '\0';
+		}
+
+		static inline bool isScalarEnd(std::string_view input, size_t i) {
+			if (i >= input.size()) return true;
+			switch (input[i]) {
+			case ' ': case '\t': case '\r': case '\n':
+			case beginArray: case endArray: case beginObject: case endObject:
+			case nameSeparator: case valueSeparator:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		// Stage 1 already proved the string is terminated, escape-free runs are found with SIMD
+		// A string without escapes is returned as a view into the input, otherwise it is decoded into decoded
+		// Either way it contains nothing to escape when it is a view
+		static inline std::string_view parseString(std::string_view input, const Index& index, size_t& i, std::string& decoded)
+		{
+			const char* data = input.data();
+			size_t runStart = index[i++] + 1;
+			size_t position = Detail::findEscapeChar(data, input.size(), runStart);
+			std::string_view string;
+
+			if (input[position] == stringEnd) {
+				string = input.substr(runStart, position - runStart);
+			}
+			else {
+				decoded.clear();
+				while (true) {
+					decoded.append(data + runStart, position - runStart);
+					if (input[position] == stringEnd) break;
+					if (input[position] != escapedCharStart) throw std::runtime_error("Unescaped control character in string");
+					Detail::decodeEscape(data, input.size(), ++position, decoded);
+					runStart = position + 1;
+					position = Detail::findEscapeChar(data, input.size(), runStart);
+				}
+				string = decoded;
+			}
+
+			if (!isScalarEnd(input, position + 1)) throw std::runtime_error("Invalid string syntax");
+			return string;
+		}
+
+		static inline bool isNumber(char c) {
+			return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == 'e' || c == 'E' || c == decimalSeparator;
+		}
+
+		template<Handler H>
+		static inline void parseNumber(std::string_view input, const Index& index, size_t& i, H& handler) {
+			size_t start = index[i++];
+			size_t end = start;
+			bool isFloat = false;
+
+			for (; end < input.size(); ++end) {
+				char c = input[end];
+				if (!isNumber(c)) break;
+				if (c == decimalSeparator || c == 'e' || c == 'E') isFloat = true;
+			}
+			if (!isScalarEnd(input, end) || !Detail::isJsonNumber(input.data() + start, input.data() + end))
+				throw std::runtime_error("Invalid number: " + std::string(input.substr(start, end - start)));
+
+			Detail::parseNumber(input.data() + start, input.data() + end, isFloat, handler);
+		}
+
+		static inline void parseLiteral(std::string_view input, const Index& index, size_t& i, const std::string& literal)
+		{
+			size_t position = index[i++];
+			if (input.compare(position, literal.size(), literal) != 0 || !isScalarEnd(input, position + literal.size()))
+				throw std::runtime_error("Invalid " + literal + " literal");
+		}
+
+		template<Handler H>
+		static void parseArray(std::string_view input, const Index& index, size_t& i, H& handler) {
+			handler.onStartArray();
+			if (peek(input, index, ++i) == endArray) { ++i; handler.onEndArray(); return; }
+			while (true) {
+				parseValue(input, index, i, handler);
+				char c = peek(input, index, i);
+				if (c == endArray) { ++i; handler.onEndArray(); return; }
+				if (c != valueSeparator) throw std::runtime_error("Expected ',' or ']'");
+				++i;
+			}
+		}
+
+		template<Handler H>
+		static void parseObject(std::string_view input, const Index& index, size_t& i, H& handler) {
+			handler.onStartObject();
+			if (peek(input, index, ++i) == endObject) { ++i; handler.onEndObject(); return; }
+			while (true) {
+				if (peek(input, index, i) != stringStart) throw std::runtime_error("Expected string key");
+				std::string decoded;
+				const std::string_view key = parseString(input, index, i, decoded);
+				Detail::reportKey(handler, key, key.data() != decoded.data());
+				if (peek(input, index, i) != nameSeparator) throw std::runtime_error("Expected ':'");
+				++i;
+				parseValue(input, index, i, handler);
+				char c = peek(input, index, i);
+				if (c == endObject) { ++i; handler.onEndObject(); return; }
+				if (c != valueSeparator) throw std::runtime_error("Expected ',' or '}'");
+				++i;
+			}
+		}
+
+		static inline bool isNumberStart(char c) {
+			return (c >= '0' && c <= '9') || c == '-';
+		}
+
+		template<Handler H>
+		static void parseValue(std::string_view input, const Index& index, size_t& i, H& handler) {
+			char c = peek(input, index, i);
+			switch (c) {
+			case beginObject: parseObject(input, index, i, handler); return;
+			case beginArray: parseArray(input, index, i, handler); return;
+			case stringStart: {
+				std::string decoded;
+				const std::string_view value = parseString(input, index, i, decoded);
+				Detail::reportString(handler, value, value.data() != decoded.data());
+				return;
+			}
+			case 't': parseLiteral(input, index, i, trueLiteral); handler.onBool(true); return;
+			case 'f': parseLiteral(input, index, i, falseLiteral); handler.onBool(false); return;
+			case 'n': parseLiteral(input, index, i, nullLiteral); handler.onNull(); return;
+			default:
+				if (isNumberStart(c)) { parseNumber(input, index, i, handler); return; }
+				if (c == '\0') throw std::runtime_error("Unexpected end of input");
+				throw std::runtime_error(std::string("Invalid value: ") + c);
+			}
+		}
+
+	public:
+		// Reports the single root value to the handler as a stream of events
+		template<Handler H>
+		static void parse(std::string_view input, H& handler)
+		{
+			try {
+				Index index;
+				Detail::StructuralIndexer::index(input, index);
+				size_t i = 0;
+				// The index always ends with a sentinel
+				if (index.size() < 2) throw std::runtime_error("Empty document");
+				parseValue(input, index, i, handler);
+				if (i + 1 != index.size()) throw std::runtime_error("Unexpected data after root value");
+			}
+			catch (const std::exception& e) {
+				throw std::runtime_error(std::string("JSON parsing failed: ") + e.what());
+			}
+		}
+
+		template<Container C, Handler H>
+		static void parse(C& input, H& handler)
+		{
+			parse(input.size() ? std::string_view(&input[0], input.size()) : std::string_view(), handler);
+		}
+
+		static Value parse(std::string_view input)
+		{
+			ValueBuilder<Value> builder;
+			parse(input, builder);
+			return builder.releaseRoot();
+		}
+
+		template<Container C>
+		static Value parse(C& input)
+		{
+			return parse(input.size() ? std::string_view(&input[0], input.size()) : std::string_view());
+		}
+	};
+}
\ No newline at end of file
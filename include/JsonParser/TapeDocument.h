@@ -0,0 +1,480 @@
+#pragma once
+#include <stdint.h>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <charconv>
+#include <algorithm>
+
+#include "JsonParser/Concepts.h"
+#include "JsonParser/Utils/Macros.h"
+#include "JsonParser/Utils/StructuralIndexer.h"
+#include "JsonParser/Utils/NumberParsing.h"
+#include "JsonParser/Utils/Escapes.h"
+
+namespace Json
+{
+	// Read-only document stored as a flat tape of 64-bit tagged words plus a single string buffer
+	// Parsing strict JSON performs a constant number of allocations and traversal never chases pointers
+	//
+	// Word layout: the top 8 bits hold the tag, the low 56 bits the payload
+	//   '[' '{'  payload bits 0..31 index past the matching close word, bits 32..55 element count
+	//   ']' '}'  payload is the index of the matching open word
+	//   '"'      payload is the offset of the string in the string buffer (uint32 length, bytes, '\0')
+	//   'l' 'd'  followed by one word holding the raw int64_t or double
+	//   't' 'f' 'n'
+	class TapeDocument
+	{
+	public:
+		enum class Type
+		{
+			Array,
+			Object,
+			String,
+			Bool,
+			Integer,
+			Number,
+			Null
+		};
+
+		class Ref;
+		class ArrayRange;
+		class ObjectRange;
+
+	private:
+		static constexpr uint64_t payloadMask = (uint64_t(1) << 56) - 1;
+		static constexpr uint64_t countMask = (uint64_t(1) << 24) - 1;
+
+		static constexpr char beginArray = '[';
+		static constexpr char endArray = ']';
+		static constexpr char beginObject = '{';
+		static constexpr char endObject = '}';
+		static constexpr char nameSeparator = ':';
+		static constexpr char valueSeparator = ',';
+		static constexpr char stringStart = '\"';
+		static constexpr char stringEnd = '\"';
+		static constexpr char escapedCharStart = '\\';
+		static constexpr char decimalSeparator = '.';
+
+		static constexpr char integerTag = 'l';
+		static constexpr char numberTag = 'd';
+		static constexpr char trueTag = 't';
+		static constexpr char falseTag = 'f';
+		static constexpr char nullTag = 'n';
+
+		static inline const std::string nullLiteral = "null";
+		static inline const std::string trueLiteral = "true";
+		static inline const std::string falseLiteral = "false";
+
+		using Index = Detail::StructuralIndex;
+
+		std::vector<uint64_t> m_tape;
+		std::string m_strings;
+
+		static inline uint64_t makeWord(char tag, uint64_t payload) {
+			return (static_cast<uint64_t>(static_cast<uint8_t>(tag)) << 56) | (payload & payloadMask);
+		}
+		static inline char tagOf(uint64_t word) { return static_cast<char>(word >> 56); }
+		static inline uint64_t payloadOf(uint64_t word) { return word & payloadMask; }
+
+		// Index of the word following the value starting at index
+		inline size_t skip(size_t index) const {
+			uint64_t word = m_tape[index];
+			switch (tagOf(word)) {
+			case beginArray:
+			case beginObject:
+				return static_cast<uint32_t>(word);
+			case integerTag:
+			case numberTag:
+				return index + 2;
+			default:
+				return index + 1;
+			}
+		}
+
+		inline std::string_view stringAt(uint64_t offset) const {
+			uint32_t length;
+			std::memcpy(&length, m_strings.data() + offset, sizeof(length));
+			return std::string_view(m_strings.data() + offset + sizeof(length), length);
+		}
+
+		// Parsing
+
+		static inline char peek(std::string_view input, const Index& index, size_t i) {
+			size_t position = index[i];
+			return position < input.size() ? input[position] : '\0';
+		}
+
+		static inline bool isScalarEnd(std::string_view input, size_t i) {
+			if (i >= input.size()) return true;
+			switch (input[i]) {
+			case ' ': case '\t': case '\r': case '\n':
+			case beginArray: case endArray: case beginObject: case endObject:
+			case nameSeparator: case valueSeparator:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		// Decodes the string straight into the string buffer, stage 1 already proved it is terminated
+		// Runs without escapes are found with SIMD, like StructuralParser
+		inline void parseString(std::string_view input, const Index& index, size_t& i)
+		{
+			const char* data = input.data();
+			size_t runStart = index[i++] + 1;
+			size_t offset = m_strings.size();
+			m_strings.append(sizeof(uint32_t), '\0');
+
+			size_t position = Detail::findEscapeChar(data, input.size(), runStart);
+			while (true) {
+				m_strings.append(data + runStart, position - runStart);
+				if (input[position] == stringEnd) break;
+				if (input[position] != escapedCharStart) throw std::runtime_error("Unescaped control character in string");
+				Detail::decodeEscape(data, input.size(), ++position, m_strings);
+				runStart = position + 1;
+				position = Detail::findEscapeChar(data, input.size(), runStart);
+			}
+			if (!isScalarEnd(input, position + 1)) throw std::runtime_error("Invalid string syntax");
+
+			uint32_t length = static_cast<uint32_t>(m_strings.size() - offset - sizeof(uint32_t));
+			std::memcpy(m_strings.data() + offset, &length, sizeof(length));
+			m_strings.push_back('\0');
+			m_tape.push_back(makeWord(stringStart, offset));
+		}
+
+		static inline bool isNumber(char c) {
+			return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == 'e' || c == 'E' || c == decimalSeparator;
+		}
+
+		inline void parseNumber(std::string_view input, const Index& index, size_t& i) {
+			size_t start = index[i++];
+			size_t end = start;
+			bool isFloat = false;
+
+			for (; end < input.size(); ++end) {
+				char c = input[end];
+				if (!isNumber(c)) break;
+				if (c == decimalSeparator || c == 'e' || c == 'E') isFloat = true;
+			}
+			const char* first = input.data() + start;
+			const char* last = input.data() + end;
+			if (!isScalarEnd(input, end) || !Detail::isJsonNumber(first, last))
+				throw std::runtime_error("Invalid number: " + std::string(first, last));
+			if (!isFloat) {
+				int64_t integer;
+				Detail::IntegerStatus status = Detail::parseInteger(first, last, integer);
+				if (status == Detail::IntegerStatus::Invalid)
+					throw std::runtime_error("Invalid number: " + std::string(first, last));
+				if (status == Detail::IntegerStatus::Ok) {
+					m_tape.push_back(makeWord(integerTag, 0));
+					m_tape.push_back(static_cast<uint64_t>(integer));
+					return;
+				}
+				// Out of int64_t range, stored as the nearest double
+			}
+
+			double number = Detail::parseDouble(first, last);
+			uint64_t raw;
+			std::memcpy(&raw, &number, sizeof(raw));
+			m_tape.push_back(makeWord(numberTag, 0));
+			m_tape.push_back(raw);
+		}
+
+		inline void parseLiteral(std::string_view input, const Index& index, size_t& i, const std::string& literal, char tag)
+		{
+			size_t position = index[i++];
+			if (input.compare(position, literal.size(), literal) != 0 || !isScalarEnd(input, position + literal.size()))
+				throw std::runtime_error("Invalid " + literal + " literal");
+			m_tape.push_back(makeWord(tag, 0));
+		}
+
+		inline void closeContainer(size_t open, char openTag, char closeTag, size_t count) {
+			m_tape.push_back(makeWord(closeTag, open));
+			m_tape[open] = makeWord(openTag, m_tape.size() | (std::min<uint64_t>(count, countMask) << 32));
+		}
+
+		void parseArray(std::string_view input, const Index& index, size_t& i) {
+			size_t open = m_tape.size();
+			m_tape.push_back(0);
+			size_t count = 0;
+			if (peek(input, index, ++i) == endArray) { ++i; closeContainer(open, beginArray, endArray, count); return; }
+			while (true) {
+				parseValue(input, index, i);
+				++count;
+				char c = peek(input, index, i);
+				if (c == endArray) { ++i; closeContainer(open, beginArray, endArray, count); return; }
+				if (c != valueSeparator) throw std::runtime_error("Expected ',' or ']'");
+				++i;
+			}
+		}
+
+		void parseObject(std::string_view input, const Index& index, size_t& i) {
+			size_t open = m_tape.size();
+			m_tape.push_back(0);
+			size_t count = 0;
+			if (peek(input, index, ++i) == endObject) { ++i; closeContainer(open, beginObject, endObject, count); return; }
+			while (true) {
+				if (peek(input, index, i) != stringStart) throw std::runtime_error("Expected string key");
+				parseString(input, index, i);
+				if (peek(input, index, i) != nameSeparator) throw std::runtime_error("Expected ':'");
+				++i;
+				parseValue(input, index, i);
+				++count;
+				char c = peek(input, index, i);
+				if (c == endObject) { ++i; closeContainer(open, beginObject, endObject, count); return; }
+				if (c != valueSeparator) throw std::runtime_error("Expected ',' or '}'");
+				++i;
+			}
+		}
+
+		static inline bool isNumberStart(char c) {
+			return (c >= '0' && c <= '9') || c == '-';
+		}
+
+		void parseValue(std::string_view input, const Index& index, size_t& i) {
+			char c = peek(input, index, i);
+			switch (c) {
+			case beginObject: return parseObject(input, index, i);
+			case beginArray: return parseArray(input, index, i);
+			case stringStart: return parseString(input, index, i);
+			case 't': return parseLiteral(input, index, i, trueLiteral, trueTag);
+			case 'f': return parseLiteral(input, index, i, falseLiteral, falseTag);
+			case 'n': return parseLiteral(input, index, i, nullLiteral, nullTag);
+			default:
+				if (isNumberStart(c)) return parseNumber(input, index, i);
+				if (c == '\0') throw std::runtime_error("Unexpected end of input");
+				throw std::runtime_error(std::string("Invalid value: ") + c);
+			}
+		}
+
+	public:
+		// Cursor to a value on the tape, valid as long as the document is alive
+		class Ref
+		{
+		private:
+			const TapeDocument* m_document = nullptr;
+			size_t m_index = 0;
+
+			friend class TapeDocument;
+			friend class ArrayRange;
+			friend class ObjectRange;
+
+			Ref(const TapeDocument* document, size_t index) : m_document(document), m_index(index) {}
+
+			inline uint64_t word() const { return m_document->m_tape[m_index]; }
+			inline char tag() const { return tagOf(word()); }
+
+		public:
+			Ref() = default;
+
+			Type getType() const {
+				switch (tag()) {
+				case beginArray: return Type::Array;
+				case beginObject: return Type::Object;
+				case stringStart: return Type::String;
+				case trueTag: case falseTag: return Type::Bool;
+				case integerTag: return Type::Integer;
+				case numberTag: return Type::Number;
+				default: return Type::Null;
+				}
+			}
+
+			bool isNull() const { return tag() == nullTag; }
+			bool isBool() const { return tag() == trueTag || tag() == falseTag; }
+			bool isNumber() const { return tag() == numberTag; }
+			bool isInteger() const { return tag() == integerTag; }
+			bool isString() const { return tag() == stringStart; }
+			bool isArray() const { return tag() == beginArray; }
+			bool isObject() const { return tag() == beginObject; }
+
+			bool asBool() const {
+				JSON_VERIFY(isBool(), "Type mismatch");
+				return tag() == trueTag;
+			}
+			int64_t asInteger() const {
+				JSON_VERIFY(isInteger(), "Type mismatch");
+				return static_cast<int64_t>(m_document->m_tape[m_index + 1]);
+			}
+			double asNumber() const {
+				JSON_VERIFY(isNumber(), "Type mismatch");
+				double number;
+				std::memcpy(&number, &m_document->m_tape[m_index + 1], sizeof(number));
+				return number;
+			}
+			std::string_view asString() const {
+				JSON_VERIFY(isString(), "Type mismatch");
+				return m_document->stringAt(payloadOf(word()));
+			}
+			inline ArrayRange asArray() const;
+			inline ObjectRange asObject() const;
+
+			// Number of elements or members, O(1) below 2^24 entries
+			size_t size() const {
+				JSON_VERIFY(isArray() || isObject(), "Type mismatch");
+				size_t count = static_cast<size_t>((payloadOf(word()) >> 32) & countMask);
+				if (count < countMask) return count;
+				count = 0;
+				size_t end = static_cast<uint32_t>(word()) - 1;
+				for (size_t i = m_index + 1; i < end; i = m_document->skip(i), ++count)
+					if (isObject()) i = m_document->skip(i);
+				return count;
+			}
+
+			bool contains(std::string_view key) const {
+				JSON_VERIFY(isObject(), "Type mismatch");
+				size_t end = static_cast<uint32_t>(word()) - 1;
+				for (size_t i = m_index + 1; i < end; i = m_document->skip(i + 1))
+					if (m_document->stringAt(payloadOf(m_document->m_tape[i])) == key) return true;
+				return false;
+			}
+
+			// Linear scan over the members, throws if the key is missing
+			Ref operator[](std::string_view key) const {
+				JSON_VERIFY(isObject(), "Type mismatch");
+				size_t end = static_cast<uint32_t>(word()) - 1;
+				for (size_t i = m_index + 1; i < end; i = m_document->skip(i + 1))
+					if (m_document->stringAt(payloadOf(m_document->m_tape[i])) == key) return Ref(m_document, i + 1);
+				throw std::runtime_error("Key not found: " + std::string(key));
+			}
+
+			// Skips over the preceding elements, prefer iterating asArray() for sequential access
+			Ref operator[](size_t index) const {
+				JSON_VERIFY(isArray(), "Type mismatch");
+				size_t end = static_cast<uint32_t>(word()) - 1;
+				size_t i = m_index + 1;
+				for (; index > 0 && i < end; --index) i = m_document->skip(i);
+				if (i >= end) throw std::out_of_range("Array index out of range");
+				return Ref(m_document, i);
+			}
+		};
+
+		class ArrayRange
+		{
+		private:
+			const TapeDocument* m_document;
+			size_t m_begin;
+			size_t m_end;
+
+			friend class Ref;
+			ArrayRange(const TapeDocument* document, size_t begin, size_t end) : m_document(document), m_begin(begin), m_end(end) {}
+
+		public:
+			class iterator
+			{
+			private:
+				const TapeDocument* m_document;
+				size_t m_index;
+
+			public:
+				using value_type = Ref;
+				using difference_type = std::ptrdiff_t;
+
+				iterator(const TapeDocument* document, size_t index) : m_document(document), m_index(index) {}
+
+				Ref operator*() const { return Ref(m_document, m_index); }
+				iterator& operator++() { m_index = m_document->skip(m_index); return *this; }
+				iterator operator++(int) { iterator copy = *this; ++*this; return copy; }
+				bool operator==(const iterator& other) const { return m_index == other.m_index; }
+				bool operator!=(const iterator& other) const { return m_index != other.m_index; }
+			};
+
+			iterator begin() const { return iterator(m_document, m_begin); }
+			iterator end() const { return iterator(m_document, m_end); }
+			bool empty() const { return m_begin == m_end; }
+		};
+
+		class ObjectRange
+		{
+		private:
+			const TapeDocument* m_document;
+			size_t m_begin;
+			size_t m_end;
+
+			friend class Ref;
+			ObjectRange(const TapeDocument* document, size_t begin, size_t end) : m_document(document), m_begin(begin), m_end(end) {}
+
+		public:
+			class iterator
+			{
+			private:
+				const TapeDocument* m_document;
+				size_t m_index;
+
+			public:
+				using value_type = std::pair<std::string_view, Ref>;
+				using difference_type = std::ptrdiff_t;
+
+				iterator(const TapeDocument* document, size_t index) : m_document(document), m_index(index) {}
+
+				value_type operator*() const {
+					return { m_document->stringAt(payloadOf(m_document->m_tape[m_index])), Ref(m_document, m_index + 1) };
+				}
+				iterator& operator++() { m_index = m_document->skip(m_index + 1); return *this; }
+				iterator operator++(int) { iterator copy = *this; ++*this; return copy; }
+				bool operator==(const iterator& other) const { return m_index == other.m_index; }
+				bool operator!=(const iterator& other) const { return m_index != other.m_index; }
+			};
+
+			iterator begin() const { return iterator(m_document, m_begin); }
+			iterator end() const { return iterator(m_document, m_end); }
+			bool empty() const { return m_begin == m_end; }
+		};
+
+		TapeDocument() = default;
+
+		TapeDocument(TapeDocument&&) noexcept = default;
+		TapeDocument& operator=(TapeDocument&&) noexcept = default;
+		TapeDocument(const TapeDocument&) = delete;
+		TapeDocument& operator=(const TapeDocument&) = delete;
+
+		bool empty() const { return m_tape.empty(); }
+
+		Ref root() const {
+			JSON_VERIFY(!m_tape.empty(), "Empty document");
+			return Ref(this, 0);
+		}
+
+		static TapeDocument parse(std::string_view input)
+		{
+			TapeDocument document;
+			try {
+				Index index;
+				Detail::StructuralIndexer::index(input, index);
+				// The index always ends with a sentinel
+				if (index.size() < 2) throw std::runtime_error("Empty document");
+				// Every structural produces at most two words and every string at most 3 bytes
+				// more than its quoted source, so neither buffer ever grows while parsing
+				document.m_tape.reserve(index.size() * 2);
+				document.m_strings.reserve(input.size() + index.size() * 3);
+
+				size_t i = 0;
+				document.parseValue(input, index, i);
+				if (i + 1 != index.size()) throw std::runtime_error("Unexpected data after root value");
+			}
+			catch (const std::exception& e) {
+				throw std::runtime_error(std::string("JSON parsing failed: ") + e.what());
+			}
+			return document;
+		}
+
+		template<Container C>
+		static TapeDocument parse(C& input)
+		{
+			return parse(input.size() ? std::string_view(&input[0], input.size()) : std::string_view());
+		}
+	};
+
+	inline TapeDocument::ArrayRange TapeDocument::Ref::asArray() const {
+		JSON_VERIFY(isArray(), "Type mismatch");
+		return ArrayRange(m_document, m_index + 1, static_cast<uint32_t>(word()) - 1);
+	}
+
+	inline TapeDocument::ObjectRange TapeDocument::Ref::asObject() const {
+		JSON_VERIFY(isObject(), "Type mismatch");
+		return ObjectRange(m_document, m_index + 1, static_cast<uint32_t>(word()) - 1);
+	}
+}
\ No newline at end of file
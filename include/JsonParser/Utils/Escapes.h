@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+// Decoding of the escape sequences in JSON strings, shared by every parser
+
+namespace Json::Detail
+{
+	// Reads the four hex digits of a \u escape through next
+	template<typename Next>
+	inline uint32_t readHex4(Next& next) {
+		uint32_t value = 0;
+		for (int digit = 0; digit < 4; ++digit) {
+			const char c = next();
+			uint32_t nibble;
+			if (c >= '0' && c <= '9') nibble = c - '0';
+			else if (c >= 'a' && c <= 'f') nibble = c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F') nibble = c - 'A' + 10;
+			else throw std::runtime_error("Invalid unicode escape");
+			value = (value << 4) | nibble;
+		}
+		return value;
+	}
+
+	inline void appendUtf8(std::string& string, uint32_t codepoint) {
+		if (codepoint <= 0x7F) {
+			string.push_back(static_cast<char>(codepoint));
+		}
+		else if (codepoint <= 0x7FF) {
+			string.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+			string.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+		}
+		else if (codepoint <= 0xFFFF) {
+			string.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+			string.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+			string.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+		}
+		else {
+			string.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+			string.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+			string.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+			string.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+		}
+	}
+
+	// Decodes the escape sequence whose first character after the backslash is escaped into string, next returns
+	// each following character the sequence needs and throws at the end of the input
+	// A high surrogate \uD800-\uDBFF has to be followed by a low one \uDC00-\uDFFF and the pair is a single code
+	// point written as 4 bytes of UTF-8, a surrogate on its own throws
+	template<typename Next>
+	inline void decodeEscape(char escaped, Next next, std::string& string) {
+		switch (escaped) {
+		case '"':  string.push_back('"'); break;
+		case '\\': string.push_back('\\'); break;
+		case '/':  string.push_back('/'); break;
+		case 'b':  string.push_back('\b'); break;
+		case 'f':  string.push_back('\f'); break;
+		case 'n':  string.push_back('\n'); break;
+		case 'r':  string.push_back('\r'); break;
+		case 't':  string.push_back('\t'); break;
+		case 'u': {
+			uint32_t codepoint = readHex4(next);
+			if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+				if (next() != '\\' || next() != 'u') throw std::runtime_error("Unpaired surrogate in unicode escape");
+				const uint32_t low = readHex4(next);
+				if (low < 0xDC00 || low > 0xDFFF) throw std::runtime_error("Unpaired surrogate in unicode escape");
+				codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+			}
+			else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+				throw std::runtime_error("Unpaired surrogate in unicode escape");
+			}
+			appendUtf8(string, codepoint);
+			break;
+		}
+		default:
+			throw std::runtime_error(std::string("Invalid escape sequence: \\") + escaped);
+		}
+	}
+
+	// Contiguous input, i is the index of the character after the backslash and is left at the last character
+	// of the sequence
+	inline void decodeEscape(const char* input, size_t size, size_t& i, std::string& string) {
+		if (i >= size) throw std::runtime_error("Unterminated escape sequence");
+		decodeEscape(input[i], [input, size, &i] {
+			if (i + 1 >= size) throw std::runtime_error("Invalid unicode escape");
+			return input[++i];
+		}, string);
+	}
+}
\ No newline at end of file
@@ -1,5 +1,16 @@
 #pragma once
 #include <stdexcept>
+#include <version>
+
+// Whether std::to_chars and std::from_chars handle double, otherwise numbers are formatted with snprintf and
+// parsed with strtod (see formatNumber and parseDouble). Defining it as 0 uses those anyway
+#ifndef JSON_FLOAT_CHARCONV
+#if defined(__cpp_lib_to_chars)
+#define JSON_FLOAT_CHARCONV 1
+#else
+#define JSON_FLOAT_CHARCONV 0
+#endif
+#endif
 
 namespace Json::Detail {
 
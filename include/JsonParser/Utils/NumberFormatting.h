@@ -0,0 +1,93 @@
+#pragma once
+#include <charconv>
+#include <cfloat>
+#include <clocale>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "JsonParser/Utils/Macros.h"
+
+// Number conversion used by Serializer, writes the characters of one number into a caller buffer
+
+namespace Json::Detail
+{
+	// Enough for any int64_t (19 digits and a sign)
+	inline constexpr size_t maxIntegerChars = 20;
+	// Enough for any double in the shortest form ("-2.2250738585072014e-308") plus ".0"
+	inline constexpr size_t maxNumberChars = 32;
+
+	// "00" to "99", two digits at a time halves the divisions
+	inline constexpr char digitPairs[] =
+		"0001020304050607080910111213141516171819"
+		"2021222324252627282930313233343536373839"
+		"4041424344454647484950515253545556575859"
+		"6061626364656667686970717273747576777879"
+		"8081828384858687888990919293949596979899";
+
+	// Writes value in decimal at out, returns the end of what was written
+	inline char* formatInteger(int64_t value, char* out) noexcept {
+		uint64_t magnitude = static_cast<uint64_t>(value);
+		if (value < 0) {
+			*out++ = '-';
+			magnitude = 0 - magnitude;
+		}
+
+		char digits[maxIntegerChars];
+		char* const end = digits + sizeof(digits);
+		char* first = end;
+		while (magnitude >= 100) {
+			const size_t pair = static_cast<size_t>(magnitude % 100) * 2;
+			magnitude /= 100;
+			first -= 2;
+			std::memcpy(first, digitPairs + pair, 2);
+		}
+		if (magnitude >= 10) {
+			first -= 2;
+			std::memcpy(first, digitPairs + magnitude * 2, 2);
+		}
+		else *--first = static_cast<char>('0' + magnitude);
+
+		const size_t count = static_cast<size_t>(end - first);
+		std::memcpy(out, first, count);
+		return out + count;
+	}
+
+	// Writes the shortest decimal form that parses back to the same double, returns the end of what was written
+	// Integral values get ".0" so they are parsed back as numbers rather than integers
+	// JSON has no NaN or infinity, they are written as null
+	inline char* formatNumber(double value, char* out) noexcept {
+		if (!std::isfinite(value)) {
+			std::memcpy(out, "null", 4);
+			return out + 4;
+		}
+#if JSON_FLOAT_CHARCONV
+		char* const end = std::to_chars(out, out + maxNumberChars, value).ptr;
+#else
+		// The fewest significant digits that strtod reads back to value. %.15g already writes the shortest decimal
+		// when one of up to 15 digits reads back to a normal double, subnormals have fewer and start from 1
+		// The locale's decimal point becomes '.'
+		int length = 0;
+		for (int precision = std::fabs(value) < DBL_MIN ? 1 : 15; precision <= 17; ++precision) {
+			length = std::snprintf(out, maxNumberChars, "%.*g", precision, value);
+			if (std::strtod(out, nullptr) == value) break;
+		}
+		char* end = out + length;
+		const char* point = std::localeconv()->decimal_point;
+		if (char* found = std::strcmp(point, ".") != 0 ? std::strstr(out, point) : nullptr) {
+			const size_t pointLength = std::strlen(point);
+			*found = '.';
+			std::memmove(found + 1, found + pointLength, end - (found + pointLength));
+			end -= pointLength - 1;
+		}
+#endif
+		for (const char* p = out; p != end; ++p) {
+			if (*p == '.' || *p == 'e') return end;
+		}
+		std::memcpy(end, ".0", 2);
+		return end + 2;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,369 @@
+#pragma once
+#include <bit>
+#include <cfloat>
+#include <charconv>
+#include <clocale>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "JsonParser/Concepts.h"
+#include "JsonParser/Utils/Macros.h"
+#include "JsonParser/Utils/PowersOfFive.h"
+
+// Number conversion shared by all parsers, works on the characters of one number in place
+
+namespace Json::Detail
+{
+	enum class IntegerStatus
+	{
+		Ok,
+		Overflow,
+		Invalid,
+	};
+
+	// True when all 8 bytes are ASCII digits
+	inline bool isEightDigits(uint64_t chunk) {
+		return ((chunk & 0xF0F0F0F0F0F0F0F0) | (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+			0x3333333333333333;
+	}
+
+	// Converts 8 ASCII digits loaded little-endian, the first digit in the lowest byte
+	// Three multiply steps combine neighbouring digits, then pairs, then quads
+	inline uint32_t parseEightDigits(uint64_t chunk) {
+		chunk -= 0x3030303030303030;
+		chunk = (chunk * 10) + (chunk >> 8);
+		chunk = (((chunk & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+			(((chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+		return static_cast<uint32_t>(chunk);
+	}
+
+	// Parses an optional '-' followed by decimal digits spanning exactly [first, last)
+	// Overflow means the digits are valid but the value does not fit int64_t
+	inline IntegerStatus parseInteger(const char* first, const char* last, int64_t& value) {
+		bool negative = false;
+		if (first != last && *first == '-') {
+			negative = true;
+			++first;
+		}
+		if (first == last) return IntegerStatus::Invalid;
+
+		const char* p = first;
+		for (; p != last && *p == '0'; ++p);
+
+		// 19 digits always fit in uint64_t, anything longer is out of int64_t range
+		if (last - p > 19) {
+			for (; p != last; ++p)
+				if (static_cast<unsigned char>(*p - '0') > 9) return IntegerStatus::Invalid;
+			return IntegerStatus::Overflow;
+		}
+
+		uint64_t result = 0;
+		if constexpr (std::endian::native == std::endian::little) {
+			while (last - p >= 8) {
+				uint64_t chunk;
+				std::memcpy(&chunk, p, sizeof(chunk));
+				if (!isEightDigits(chunk)) return IntegerStatus::Invalid;
+				result = result * 100000000 + parseEightDigits(chunk);
+				p += 8;
+			}
+		}
+		for (; p != last; ++p) {
+			unsigned digit = static_cast<unsigned char>(*p - '0');
+			if (digit > 9) return IntegerStatus::Invalid;
+			result = result * 10 + digit;
+		}
+
+		constexpr uint64_t maxPositive = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+		if (negative) {
+			if (result > maxPositive + 1) return IntegerStatus::Overflow;
+			value = static_cast<int64_t>(0 - result);
+		}
+		else {
+			if (result > maxPositive) return IntegerStatus::Overflow;
+			value = static_cast<int64_t>(result);
+		}
+		return IntegerStatus::Ok;
+	}
+
+	inline uint64_t multiply128(uint64_t a, uint64_t b, uint64_t& high) {
+#if defined(__SIZEOF_INT128__)
+		unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+		high = static_cast<uint64_t>(product >> 64);
+		return static_cast<uint64_t>(product);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		return _umul128(a, b, &high);
+#else
+		uint64_t aLow = a & 0xFFFFFFFF, aHigh = a >> 32;
+		uint64_t bLow = b & 0xFFFFFFFF, bHigh = b >> 32;
+		uint64_t lowLow = aLow * bLow;
+		uint64_t highLow = aHigh * bLow + (lowLow >> 32);
+		uint64_t lowHigh = aLow * bHigh + (highLow & 0xFFFFFFFF);
+		high = aHigh * bHigh + (highLow >> 32) + (lowHigh >> 32);
+		return (lowHigh << 32) | (lowLow & 0xFFFFFFFF);
+#endif
+	}
+
+	// Eisel-Lemire: the exactly rounded double closest to mantissa * 10^exponent, mantissa != 0
+	// Follows the fallback-free variant proven by Mushtak and Lemire, exact for untruncated mantissas
+	// Returns the raw bits without the sign, the exponent field is 0x7FF on overflow
+	inline uint64_t eiselLemire(uint64_t mantissa, int64_t exponent) {
+		constexpr int mantissaBits = 52;
+		constexpr int infinitePower = 0x7FF;
+
+		if (exponent < smallestPowerOfFive) return 0;
+		if (exponent > largestPowerOfFive) return uint64_t(infinitePower) << mantissaBits;
+
+		int leadingZeros = std::countl_zero(mantissa);
+		mantissa <<= leadingZeros;
+
+		// Only the top 55 bits of the product matter, the second half of the power is needed
+		// only when the truncated product could carry into them
+		const size_t index = 2 * static_cast<size_t>(exponent - smallestPowerOfFive);
+		uint64_t high;
+		uint64_t low = multiply128(mantissa, powerOfFive128[index], high);
+		constexpr uint64_t precisionMask = ~uint64_t(0) >> (mantissaBits + 3);
+		if ((high & precisionMask) == precisionMask) {
+			uint64_t secondHigh;
+			multiply128(mantissa, powerOfFive128[index + 1], secondHigh);
+			low += secondHigh;
+			if (secondHigh > low) ++high;
+		}
+
+		int upperBit = static_cast<int>(high >> 63);
+		int shift = upperBit + 64 - mantissaBits - 3;
+		uint64_t result = high >> shift;
+		// floor(log2(10^exponent)) + 63 + 1023, the binary exponent of the product
+		int32_t power2 = static_cast<int32_t>((((152170 + 65536) * exponent) >> 16) + 63 + upperBit - leadingZeros + 1023);
+
+		if (power2 <= 0) {
+			// Subnormal result
+			if (-power2 + 1 >= 64) return 0;
+			result >>= -power2 + 1;
+			result += result & 1;
+			result >>= 1;
+			power2 = result < (uint64_t(1) << mantissaBits) ? 0 : 1;
+			return (uint64_t(power2) << mantissaBits) | (result & ~(uint64_t(1) << mantissaBits));
+		}
+
+		// Exactly halfway between two doubles: round to even instead of up
+		if (low <= 1 && exponent >= -4 && exponent <= 23 && (result & 3) == 1 && (result << shift) == high)
+			result &= ~uint64_t(1);
+
+		result += result & 1;
+		result >>= 1;
+		if (result >= (uint64_t(2) << mantissaBits)) {
+			result = uint64_t(1) << mantissaBits;
+			++power2;
+		}
+		result &= ~(uint64_t(1) << mantissaBits);
+		if (power2 >= infinitePower) return uint64_t(infinitePower) << mantissaBits;
+		return (uint64_t(power2) << mantissaBits) | result;
+	}
+
+	inline bool isDigit(char c) {
+		return static_cast<unsigned char>(c - '0') <= 9;
+	}
+
+	// Whether [first, last) follows the JSON number grammar: an optional minus, an integer part without leading
+	// zeros, then optionally a fraction and an exponent with at least one digit each
+	inline bool isJsonNumber(const char* first, const char* last) noexcept {
+		const char* p = first;
+		if (p != last && *p == '-') ++p;
+		if (p == last || !isDigit(*p)) return false;
+		if (*p++ != '0') {
+			while (p != last && isDigit(*p)) ++p;
+		}
+		if (p != last && *p == '.') {
+			if (++p == last || !isDigit(*p)) return false;
+			while (p != last && isDigit(*p)) ++p;
+		}
+		if (p != last && (*p == 'e' || *p == 'E')) {
+			if (++p != last && (*p == '+' || *p == '-')) ++p;
+			if (p == last || !isDigit(*p)) return false;
+			while (p != last && isDigit(*p)) ++p;
+		}
+		return p == last;
+	}
+
+	// Parses a decimal floating-point number spanning exactly [first, last), locale independent
+	// Up to 19 significant digits go through the Clinger fast path or Eisel-Lemire, longer
+	// mantissas fall back to the standard library, the result is always correctly rounded
+	inline double parseDouble(const char* first, const char* last) {
+		const char* p = first;
+		bool negative = false;
+		if (p != last && *p == '-') {
+			negative = true;
+			++p;
+		}
+		const char* digitsStart = p;
+
+		uint64_t mantissa = 0;
+		int64_t exponent = 0;
+		int digits = 0;
+		bool anyDigit = false;
+		bool truncated = false;
+
+		// Integer part, leading zeros are not significant
+		for (; p != last && isDigit(*p); ++p) {
+			anyDigit = true;
+			unsigned digit = static_cast<unsigned char>(*p - '0');
+			if (digits < 19) {
+				mantissa = mantissa * 10 + digit;
+				if (mantissa != 0) ++digits;
+			}
+			else {
+				++exponent;
+				truncated |= digit != 0;
+			}
+		}
+
+		if (p != last && *p == '.') {
+			++p;
+			// Eight fraction digits at a time while they still fit the mantissa
+			if constexpr (std::endian::native == std::endian::little) {
+				while (mantissa != 0 && digits <= 11 && last - p >= 8) {
+					uint64_t chunk;
+					std::memcpy(&chunk, p, sizeof(chunk));
+					if (!isEightDigits(chunk)) break;
+					mantissa = mantissa * 100000000 + parseEightDigits(chunk);
+					digits += 8;
+					exponent -= 8;
+					anyDigit = true;
+					p += 8;
+				}
+			}
+			for (; p != last && isDigit(*p); ++p) {
+				anyDigit = true;
+				unsigned digit = static_cast<unsigned char>(*p - '0');
+				if (digits < 19) {
+					mantissa = mantissa * 10 + digit;
+					if (mantissa != 0) ++digits;
+					--exponent;
+				}
+				else {
+					truncated |= digit != 0;
+				}
+			}
+		}
+		if (!anyDigit) throw std::runtime_error("Invalid number: " + std::string(first, last));
+
+		if (p != last && (*p == 'e' || *p == 'E')) {
+			++p;
+			bool negativeExponent = false;
+			if (p != last && (*p == '-' || *p == '+')) {
+				negativeExponent = *p == '-';
+				++p;
+			}
+			if (p == last || !isDigit(*p)) throw std::runtime_error("Invalid number: " + std::string(first, last));
+			int64_t explicitExponent = 0;
+			for (; p != last && isDigit(*p); ++p) {
+				// Anything this large under- or overflows regardless of the mantissa
+				if (explicitExponent < 100000) explicitExponent = explicitExponent * 10 + (*p - '0');
+			}
+			exponent += negativeExponent ? -explicitExponent : explicitExponent;
+		}
+		if (p != last) throw std::runtime_error("Invalid number: " + std::string(first, last));
+
+		double value;
+		if (mantissa == 0) {
+			value = 0.0;
+		}
+		else if (!truncated) {
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+			// Clinger: both operands are exact doubles, so one IEEE operation rounds correctly
+			static constexpr double powersOfTen[] = {
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+			if (mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+				value = static_cast<double>(mantissa);
+				value = exponent < 0 ? value / powersOfTen[-exponent] : value * powersOfTen[exponent];
+				return negative ? -value : value;
+			}
+#endif
+			uint64_t bits = eiselLemire(mantissa, exponent);
+			if ((bits >> 52) == 0x7FF) throw std::runtime_error("Number out of range: " + std::string(first, last));
+			std::memcpy(&value, &bits, sizeof(value));
+		}
+		else {
+#if JSON_FLOAT_CHARCONV
+			auto result = std::from_chars(digitsStart, last, value);
+			if (result.ec == std::errc::result_out_of_range) {
+				// The 19 digits kept in mantissa tell which way: like Eisel-Lemire, too small is zero and too large throws
+				if (exponent + digits > 0) throw std::runtime_error("Number out of range: " + std::string(first, last));
+				value = 0.0;
+			}
+			else if (result.ec != std::errc() || result.ptr != last) throw std::runtime_error("Invalid number: " + std::string(first, last));
+#else
+			// strtod expects the locale's decimal point, it underflows to zero or a subnormal like from_chars
+			std::string text(digitsStart, last);
+			const char* point = std::localeconv()->decimal_point;
+			const size_t dot = text.find('.');
+			if (dot != std::string::npos && std::strcmp(point, ".") != 0) text.replace(dot, 1, point);
+			char* end;
+			value = std::strtod(text.c_str(), &end);
+			if (end != text.c_str() + text.size()) throw std::runtime_error("Invalid number: " + std::string(first, last));
+			if (value == HUGE_VAL) throw std::runtime_error("Number out of range: " + std::string(first, last));
+#endif
+		}
+		return negative ? -value : value;
+	}
+
+	// The lenient parsers accept a '+' in front of a number, the functions here only '-'
+	inline const char* skipLeadingPlus(const char* first, const char* last) noexcept {
+		return last - first > 1 && *first == '+' && first[1] != '+' && first[1] != '-' ? first + 1 : first;
+	}
+
+	// Reports the number spanning [first, last) to the handler
+	// Integers outside the int64_t range are reported as the nearest double
+	template<Handler H>
+	inline void parseNumber(const char* first, const char* last, bool isFloat, H& handler) {
+		if (!isFloat) {
+			int64_t integer;
+			switch (parseInteger(first, last, integer)) {
+			case IntegerStatus::Ok:
+				handler.onInt64(integer);
+				return;
+			case IntegerStatus::Invalid:
+				throw std::runtime_error("Invalid number: " + std::string(first, last));
+			case IntegerStatus::Overflow:
+				break;
+			}
+		}
+		handler.onDouble(parseDouble(first, last));
+	}
+
+	// Collects the characters of a number read from a stream
+	// Numbers up to 64 characters never touch the heap
+	class NumberBuffer
+	{
+	private:
+		char m_inline[64];
+		size_t m_size = 0;
+		std::string m_spill;
+
+	public:
+		inline void push(char c) {
+			if (m_size < sizeof(m_inline)) {
+				m_inline[m_size++] = c;
+				return;
+			}
+			if (m_spill.empty()) m_spill.assign(m_inline, m_size);
+			m_spill.push_back(c);
+			++m_size;
+		}
+
+		inline const char* data() const { return m_spill.empty() ? m_inline : m_spill.data(); }
+		inline size_t size() const { return m_size; }
+	};
+}
\ No newline at end of file
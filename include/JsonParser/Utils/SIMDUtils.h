@@ -2,20 +2,38 @@
 #include <cstddef>
 #include <array>
 #include <stdexcept>
+#include <cstdint>
 
-#if defined(__x86_64__) || defined(_M_X64) || defined(__i386) || defined(_M_IX86)
+// HAS_SSE2 / HAS_AVX2 / HAS_AVX512 mean the kernels can be compiled, whether they run is decided at runtime
+// through cpuFeatures(), so one binary uses the widest path the host CPU supports
+// Wider kernels are built with per-function target attributes (MSVC accepts the intrinsics without them)
+// Define JSON_NO_SIMD to build the scalar kernels only, JSON_NO_AVX512 to leave out the 64-byte kernels
+#if !defined(JSON_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386) || defined(_M_IX86))
 #include <immintrin.h>
 #define HAS_SSE2
-#if defined(__AVX2__) || (defined(_MSC_VER) && defined(__AVX2__))
+#if defined(__GNUC__) || defined(__clang__)
+#include <cpuid.h>
 #define HAS_AVX2
+#define JSON_TARGET_AVX2 __attribute__((target("avx2,bmi")))
+#define JSON_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,bmi")))
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define HAS_AVX2
+#define JSON_TARGET_AVX2
+#define JSON_TARGET_AVX512
+#endif
+#if defined(HAS_AVX2) && !defined(JSON_NO_AVX512)
+#define HAS_AVX512
 #endif
 #endif
 
 #ifdef _MSC_VER
 #include <intrin.h>
+#define CTZ64(x) _tzcnt_u64(x)
 #define CTZ32(x) _tzcnt_u32(x)
 #define CTZ16(x) _tzcnt_u16(x)
 #elif defined(__GNUC__) || defined(__clang__)
+#define CTZ64(x) __builtin_ctzll(x)
 #define CTZ32(x) __builtin_ctz(x)
 #define CTZ16(x) __builtin_ctz(x)
 #else
@@ -31,8 +49,76 @@ namespace
         while ((x & 1) == 0 && x != 0) { x >>= 1; count++; }
         return count;
     }
+    inline int CTZ64_FUNC(uint64_t x) {
+        int count = 0;
+        while ((x & 1) == 0 && x != 0) { x >>= 1; count++; }
+        return count;
+    }
 }
+#define CTZ64(x) CTZ64_FUNC(x)
 #define CTZ32(x) CTZ32_FUNC(x)
 #define CTZ16(x) CTZ16_FUNC(x)
 #endif
 
+namespace Json::Detail
+{
+	struct CpuFeatures
+	{
+		bool sse2 = false;
+		bool avx2 = false;
+		bool avx512bw = false;
+	};
+
+	inline CpuFeatures detectCpuFeatures() {
+		CpuFeatures features;
+#if defined(HAS_SSE2)
+		uint32_t regs[4] = {};
+		auto cpuid = [&regs](uint32_t leaf, uint32_t subleaf) {
+#if defined(_MSC_VER) && !defined(__clang__)
+			int out[4];
+			__cpuidex(out, static_cast<int>(leaf), static_cast<int>(subleaf));
+			for (int k = 0; k < 4; ++k) regs[k] = static_cast<uint32_t>(out[k]);
+#else
+			__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+		};
+
+		cpuid(0, 0);
+		const uint32_t maxLeaf = regs[0];
+		if (maxLeaf < 1) return features;
+
+		cpuid(1, 0);
+		features.sse2 = (regs[3] >> 26) & 1;
+		const bool osxsave = (regs[2] >> 27) & 1;
+		const bool avx = (regs[2] >> 28) & 1;
+		if (!osxsave || !avx || maxLeaf < 7) return features;
+
+		// The OS has to save the ymm registers on context switch, otherwise AVX is unusable
+		uint64_t xcr0;
+#if defined(_MSC_VER) && !defined(__clang__)
+		xcr0 = _xgetbv(0);
+#else
+		uint32_t xcr0Low, xcr0High;
+		__asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+		xcr0 = (static_cast<uint64_t>(xcr0High) << 32) | xcr0Low;
+#endif
+		if ((xcr0 & 0x6) != 0x6) return features;
+
+		cpuid(7, 0);
+		const bool bmi1 = (regs[1] >> 3) & 1;
+		features.avx2 = ((regs[1] >> 5) & 1) && bmi1;
+
+		// AVX-512 additionally needs the OS to save the opmask and zmm registers
+		const bool avx512f = (regs[1] >> 16) & 1;
+		const bool avx512bw = (regs[1] >> 30) & 1;
+		features.avx512bw = features.avx2 && avx512f && avx512bw && (xcr0 & 0xE0) == 0xE0;
+#endif
+		return features;
+	}
+
+	// Detected once per process, every dispatcher reads the same result
+	inline const CpuFeatures& cpuFeatures() {
+		static const CpuFeatures features = detectCpuFeatures();
+		return features;
+	}
+}
\ No newline at end of file
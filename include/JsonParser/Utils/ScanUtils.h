@@ -0,0 +1,625 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "JsonParser/Utils/SIMDUtils.h"
+
+// Scanning kernels shared by the container parsers and the on-demand API
+// All of them work on contiguous input and never read past size
+// The widest variant the CPU supports is picked once per process, see scanKernels()
+
+namespace Json::Detail
+{
+	static constexpr char commentStart = '/';
+	static constexpr char lineComment = '/';
+	static constexpr char blockCommentStart = '*';
+	static constexpr char blockCommentEnd = '*';
+
+	inline bool isWhitespace(char c) {
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	// Returns the index of the last character of the comment starting at i
+	inline size_t skipCommentScalar(const char* input, size_t size, size_t i) {
+		++i;
+		if (i >= size) throw std::runtime_error("Invalid comment syntax");
+		char c = input[i];
+		++i;
+		if (c == lineComment) {
+			for (; i < size && input[i] != '\n'; ++i); // skip to end of line
+			return i;
+		}
+		else if (c == blockCommentStart) {
+			for (; i < size; ++i)
+			{
+				if (input[i] == blockCommentEnd && ++i < size && input[i] == commentStart) {
+					return i;
+				}
+			}
+			throw std::runtime_error("Endless block comment");
+		}
+		throw std::runtime_error("Invalid comment syntax");
+	}
+
+	inline size_t skipWhitespaceScalar(const char* input, size_t size, size_t i) {
+		for (; i < size; ++i) {
+			char c = input[i];
+			if (isWhitespace(c)) continue;
+			if (c == commentStart) {
+				i = skipCommentScalar(input, size, i);
+				continue;
+			}
+			return i;
+		}
+		return i;
+	}
+
+	// Whitespace only, for the strict parsers that do not accept comments
+	inline size_t skipSpacesScalar(const char* input, size_t size, size_t i) {
+		for (; i < size && isWhitespace(input[i]); ++i);
+		return i;
+	}
+
+	// Returns the index of the first '"' or '\' at or after i, or size if there is none
+	inline size_t findStringDelimiterScalar(const char* input, size_t size, size_t i) {
+		for (; i < size; ++i) {
+			char c = input[i];
+			if (c == '"' || c == '\\') return i;
+		}
+		return i;
+	}
+
+	// Returns the index of the first character a JSON string has to escape ('"', '\' or a control character
+	// below 0x20) at or after i, or size if there is none
+	inline size_t findEscapeCharScalar(const char* input, size_t size, size_t i) {
+		for (; i < size; ++i) {
+			const unsigned char c = static_cast<unsigned char>(input[i]);
+			if (c == '"' || c == '\\' || c < 0x20) return i;
+		}
+		return i;
+	}
+
+	// Returns the index of the first character that can change the nesting depth
+	// ('"', '{', '}', '[', ']' or a comment start) at or after i, or size if there is none
+	inline size_t findNestingCharScalar(const char* input, size_t size, size_t i) {
+		for (; i < size; ++i) {
+			switch (input[i]) {
+			case '"': case '{': case '}': case '[': case ']': case commentStart:
+				return i;
+			default:
+				break;
+			}
+		}
+		return i;
+	}
+
+#ifdef HAS_AVX512
+	// Full blocks use a plain load, the tail a masked one that never touches memory past size
+	// Lanes past size read as zero, which matches none of the searched characters
+	JSON_TARGET_AVX512 inline __m512i loadBlock64(const char* input, size_t size, size_t i, uint64_t& valid) {
+		if (i + 64 <= size) {
+			valid = ~uint64_t(0);
+			return _mm512_loadu_si512(input + i);
+		}
+		valid = (uint64_t(1) << (size - i)) - 1;
+		return _mm512_maskz_loadu_epi8(valid, input + i);
+	}
+
+	// One shuffle instead of four compares: the table holds the whitespace character for
+	// each low nibble it can have, every other byte can never match its own nibble entry
+	JSON_TARGET_AVX512 inline uint64_t whitespaceMask64(__m512i chunk) {
+		// Bytes ' ' at 0, '\t' at 9, '\n' at 10 and '\r' at 13, repeated in every 128-bit lane
+		const __m512i table = _mm512_set4_epi32(0x00000D00, 0x000A0900, 0, 0x00000020);
+		return _mm512_cmpeq_epi8_mask(_mm512_shuffle_epi8(table, chunk), chunk);
+	}
+
+	JSON_TARGET_AVX512 inline size_t skipCommentSIMD64(const char* input, size_t size, size_t i) {
+		++i;
+		if (i >= size) throw std::runtime_error("Invalid comment syntax");
+		char c = input[i];
+		++i;
+		if (c == lineComment) {
+			const __m512i lf = _mm512_set1_epi8('\n');
+			for (; i < size; i += 64) {
+				uint64_t valid;
+				__m512i chunk = loadBlock64(input, size, i, valid);
+				uint64_t mask = _mm512_cmpeq_epi8_mask(chunk, lf);
+				if (mask != 0)
+					return i + CTZ64(mask);
+			}
+			return size;
+		}
+		else if (c == blockCommentStart) {
+			const __m512i star = _mm512_set1_epi8(blockCommentEnd);
+			const __m512i slash = _mm512_set1_epi8(commentStart);
+			uint64_t prevStar = 0;
+			for (; i < size; i += 64) {
+				uint64_t valid;
+				__m512i chunk = loadBlock64(input, size, i, valid);
+				uint64_t stars = _mm512_cmpeq_epi8_mask(chunk, star);
+				uint64_t slashes = _mm512_cmpeq_epi8_mask(chunk, slash);
+				// A '/' right after a '*', which may be the last byte of the previous block
+				uint64_t ends = slashes & (stars << 1 | prevStar);
+				if (ends != 0)
+					return i + CTZ64(ends);
+				prevStar = stars >> 63;
+			}
+			throw std::runtime_error("Endless block comment");
+		}
+		throw std::runtime_error("Invalid comment syntax");
+	}
+
+	JSON_TARGET_AVX512 inline size_t skipWhitespaceSIMD64(const char* input, size_t size, size_t i) {
+		while (i < size) {
+			uint64_t valid;
+			__m512i chunk = loadBlock64(input, size, i, valid);
+			uint64_t mask = ~whitespaceMask64(chunk) & valid;
+			if (mask != 0) {
+				size_t j = i + CTZ64(mask);
+				if (input[j] == commentStart) {
+					i = skipCommentSIMD64(input, size, j) + 1;
+					continue;
+				}
+				return j;
+			}
+			i += 64;
+		}
+		return size;
+	}
+
+	JSON_TARGET_AVX512 inline size_t skipSpacesSIMD64(const char* input, size_t size, size_t i) {
+		for (; i < size; i += 64) {
+			uint64_t valid;
+			__m512i chunk = loadBlock64(input, size, i, valid);
+			uint64_t mask = ~whitespaceMask64(chunk) & valid;
+			if (mask != 0)
+				return i + CTZ64(mask);
+		}
+		return size;
+	}
+
+	JSON_TARGET_AVX512 inline size_t findStringDelimiterSIMD64(const char* input, size_t size, size_t i) {
+		const __m512i quote = _mm512_set1_epi8('"');
+		const __m512i backslash = _mm512_set1_epi8('\\');
+
+		for (; i < size; i += 64) {
+			uint64_t valid;
+			__m512i chunk = loadBlock64(input, size, i, valid);
+			uint64_t mask = _mm512_cmpeq_epi8_mask(chunk, quote) |
+				_mm512_cmpeq_epi8_mask(chunk, backslash);
+			if (mask != 0)
+				return i + CTZ64(mask);
+		}
+		return size;
+	}
+
+	JSON_TARGET_AVX512 inline size_t findEscapeCharSIMD64(const char* input, size_t size, size_t i) {
+		const __m512i quote = _mm512_set1_epi8('"');
+		const __m512i backslash = _mm512_set1_epi8('\\');
+		const __m512i lastControl = _mm512_set1_epi8(0x1F);
+
+		for (; i < size; i += 64) {
+			uint64_t valid;
+			__m512i chunk = loadBlock64(input, size, i, valid);
+			// The zero lanes past size count as control characters, valid drops them
+			uint64_t mask = (_mm512_cmpeq_epi8_mask(chunk, quote) | _mm512_cmpeq_epi8_mask(chunk, backslash) |
+				_mm512_cmple_epu8_mask(chunk, lastControl)) & valid;
+			if (mask != 0)
+				return i + CTZ64(mask);
+		}
+		return size;
+	}
+
+	JSON_TARGET_AVX512 inline size_t findNestingCharSIMD64(const char* input, size_t size, size_t i) {
+		const __m512i quote = _mm512_set1_epi8('"');
+		const __m512i slash = _mm512_set1_epi8('/');
+		const __m512i caseBit = _mm512_set1_epi8(0x20);
+		const __m512i braceOpen = _mm512_set1_epi8('{');
+		const __m512i braceClose = _mm512_set1_epi8('}');
+
+		for (; i < size; i += 64) {
+			uint64_t valid;
+			__m512i chunk = loadBlock64(input, size, i, valid);
+			// '[' and ']' differ from '{' and '}' only by the 0x20 bit
+			__m512i folded = _mm512_or_si512(chunk, caseBit);
+			uint64_t mask = _mm512_cmpeq_epi8_mask(chunk, quote) |
+				_mm512_cmpeq_epi8_mask(chunk, slash) |
+				_mm512_cmpeq_epi8_mask(folded, braceOpen) |
+				_mm512_cmpeq_epi8_mask(folded, braceClose);
+			if (mask != 0)
+				return i + CTZ64(mask);
+		}
+		return size;
+	}
+#endif
+
+#ifdef HAS_AVX2
+	JSON_TARGET_AVX2 inline size_t skipCommentSIMD32(const char* input, size_t size, size_t i) {
+
+		static const __m256i ws_star = _mm256_set1_epi8('*');
+		static const __m256i ws_lf = _mm256_set1_epi8('\n');
+		__m256i chunk;
+		uint32_t mask;
+
+		i += 2;
+		if (i >= size)
+			throw std::runtime_error("Invalid comment syntax");
+		else if (input[i - 1] == '/')
+		{
+			while (i + 32 <= size) {
+				chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input[i]));
+				mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, ws_lf));
+				if (mask != 0)
+					return i + CTZ32(mask);
+				i += 32;
+			}
+			for (; i < size && input[i] != '\n'; ++i);
+			return i;
+		}
+		else if (input[i - 1] == '*')
+		{
+			while (i + 32 <= size) {
+				chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input[i]));
+				mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, ws_star));
+				if (mask != 0) {
+					size_t j = i + CTZ32(mask) + 1;
+					if (j >= size)
+						throw std::runtime_error("Invalid comment syntax");
+					else if (input[j] == '/')
+						return j;
+					i = j + 1;
+					continue;
+				}
+				i += 32;
+			}
+			for (; i < size; ++i)
+			{
+				if (input[i] == '*' && ++i < size && input[i] == '/') {
+					return i;
+				}
+			}
+			throw std::runtime_error("Endless block comment");
+		}
+		throw std::runtime_error(std::string("Invalid comment syntax") + input[i]);
+	}
+
+	JSON_TARGET_AVX2 inline size_t skipWhitespaceSIMD32(const char* input, size_t size, size_t i) {
+		static const __m256i ws_space = _mm256_set1_epi8(' ');
+		static const __m256i ws_tab = _mm256_set1_epi8('\t');
+		static const __m256i ws_cr = _mm256_set1_epi8('\r');
+		static const __m256i ws_lf = _mm256_set1_epi8('\n');
+
+		__m256i chunk;
+		uint32_t mask;
+
+		while (i + 32 <= size) {
+			chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input[i]));
+
+			mask = ~_mm256_movemask_epi8(_mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(chunk, ws_space), _mm256_cmpeq_epi8(chunk, ws_tab)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(chunk, ws_cr), _mm256_cmpeq_epi8(chunk, ws_lf))));
+
+			if (mask != 0) {
+				size_t j = i + CTZ32(mask);
+				if (input[j] == '/')
+				{
+					i = skipCommentSIMD32(input, size, j) + 1;
+					continue;
+				}
+				return j;
+			}
+
+			i += 32;
+		}
+
+		return skipWhitespaceScalar(input, size, i);
+	}
+
+	JSON_TARGET_AVX2 inline size_t skipSpacesSIMD32(const char* input, size_t size, size_t i) {
+		static const __m256i ws_space = _mm256_set1_epi8(' ');
+		static const __m256i ws_tab = _mm256_set1_epi8('\t');
+		static const __m256i ws_cr = _mm256_set1_epi8('\r');
+		static const __m256i ws_lf = _mm256_set1_epi8('\n');
+
+		while (i + 32 <= size) {
+			__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input[i]));
+			uint32_t mask = ~_mm256_movemask_epi8(_mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(chunk, ws_space), _mm256_cmpeq_epi8(chunk, ws_tab)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(chunk, ws_cr), _mm256_cmpeq_epi8(chunk, ws_lf))));
+			if (mask != 0)
+				return i + CTZ32(mask);
+			i += 32;
+		}
+		return skipSpacesScalar(input, size, i);
+	}
+
+	JSON_TARGET_AVX2 inline size_t findStringDelimiterSIMD32(const char* input, size_t size, size_t i) {
+		static const __m256i quote = _mm256_set1_epi8('"');
+		static const __m256i backslash = _mm256_set1_epi8('\\');
+
+		while (i + 32 <= size) {
+			__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input[i]));
+			uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(
+				_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)));
+			if (mask != 0)
+				return i + CTZ32(mask);
+			i += 32;
+		}
+		return findStringDelimiterScalar(input, size, i);
+	}
+
+	JSON_TARGET_AVX2 inline size_t findEscapeCharSIMD32(const char* input, size_t size, size_t i) {
+		const __m256i quote = _mm256_set1_epi8('"');
+		const __m256i backslash = _mm256_set1_epi8('\\');
+		const __m256i lastControl = _mm256_set1_epi8(0x1F);
+
+		while (i + 32 <= size) {
+			__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input[i]));
+			// Unsigned chunk <= 0x1F, there is no unsigned byte compare
+			__m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, lastControl), chunk);
+			uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(control, _mm256_or_si256(
+				_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash))));
+			if (mask != 0)
+				return i + CTZ32(mask);
+			i += 32;
+		}
+		return findEscapeCharScalar(input, size, i);
+	}
+
+	JSON_TARGET_AVX2 inline size_t findNestingCharSIMD32(const char* input, size_t size, size_t i) {
+		static const __m256i quote = _mm256_set1_epi8('"');
+		static const __m256i slash = _mm256_set1_epi8('/');
+		static const __m256i caseBit = _mm256_set1_epi8(0x20);
+		static const __m256i braceOpen = _mm256_set1_epi8('{');
+		static const __m256i braceClose = _mm256_set1_epi8('}');
+
+		while (i + 32 <= size) {
+			__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input[i]));
+			// '[' and ']' differ from '{' and '}' only by the 0x20 bit
+			__m256i folded = _mm256_or_si256(chunk, caseBit);
+			uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, slash)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(folded, braceOpen), _mm256_cmpeq_epi8(folded, braceClose))));
+			if (mask != 0)
+				return i + CTZ32(mask);
+			i += 32;
+		}
+		return findNestingCharScalar(input, size, i);
+	}
+#endif
+
+#ifdef HAS_SSE2
+	inline size_t skipCommentSIMD16(const char* input, size_t size, size_t i) {
+
+		static const __m128i ws_star = _mm_set1_epi8('*');
+		static const __m128i ws_lf = _mm_set1_epi8('\n');
+		__m128i chunk;
+		uint16_t mask;
+
+		i += 2;
+		if (i >= size)
+			throw std::runtime_error("Invalid comment syntax");
+		char c = input[i - 1];
+		if (c == '/')
+		{
+			while (i + 16 <= size) {
+				chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
+				mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, ws_lf));
+				if (mask != 0)
+					return i + CTZ16(mask);
+				i += 16;
+			}
+			for (; i < size && input[i] != '\n'; ++i);
+			return i;
+		}
+		else if (c == '*')
+		{
+			while (i + 16 <= size) {
+				chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
+				mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, ws_star));
+				if (mask != 0) {
+					size_t j = i + CTZ16(mask) + 1;
+					if (j >= size)
+						throw std::runtime_error("Invalid comment syntax");
+					else if (input[j] == '/')
+						return j;
+					i = j + 1;
+					continue;
+				}
+				i += 16;
+			}
+			for (; i < size; ++i)
+			{
+				if (input[i] == '*' && ++i < size && input[i] == '/') {
+					return i;
+				}
+			}
+			throw std::runtime_error("Endless block comment");
+		}
+		throw std::runtime_error(std::string("Invalid comment syntax") + input[i]);
+	}
+
+	inline size_t skipWhitespaceSIMD16(const char* input, size_t size, size_t i) {
+		static const __m128i ws_space = _mm_set1_epi8(' ');
+		static const __m128i ws_tab = _mm_set1_epi8('\t');
+		static const __m128i ws_cr = _mm_set1_epi8('\r');
+		static const __m128i ws_lf = _mm_set1_epi8('\n');
+
+		__m128i chunk;
+		uint16_t mask;
+
+		while (i + 16 <= size) {
+			chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
+
+			mask = ~_mm_movemask_epi8(_mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(chunk, ws_space), _mm_cmpeq_epi8(chunk, ws_tab)),
+				_mm_or_si128(_mm_cmpeq_epi8(chunk, ws_cr), _mm_cmpeq_epi8(chunk, ws_lf))));
+
+			if (mask != 0) {
+				size_t j = i + CTZ16(mask);
+				if (input[j] == '/')
+				{
+					i = skipCommentSIMD16(input, size, j) + 1;
+					continue;
+				}
+				return j;
+			}
+
+			i += 16;
+		}
+
+		return skipWhitespaceScalar(input, size, i);
+	}
+
+	inline size_t skipSpacesSIMD16(const char* input, size_t size, size_t i) {
+		static const __m128i ws_space = _mm_set1_epi8(' ');
+		static const __m128i ws_tab = _mm_set1_epi8('\t');
+		static const __m128i ws_cr = _mm_set1_epi8('\r');
+		static const __m128i ws_lf = _mm_set1_epi8('\n');
+
+		while (i + 16 <= size) {
+			__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
+			uint16_t mask = ~_mm_movemask_epi8(_mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(chunk, ws_space), _mm_cmpeq_epi8(chunk, ws_tab)),
+				_mm_or_si128(_mm_cmpeq_epi8(chunk, ws_cr), _mm_cmpeq_epi8(chunk, ws_lf))));
+			if (mask != 0)
+				return i + CTZ16(mask);
+			i += 16;
+		}
+		return skipSpacesScalar(input, size, i);
+	}
+
+	inline size_t findStringDelimiterSIMD16(const char* input, size_t size, size_t i) {
+		static const __m128i quote = _mm_set1_epi8('"');
+		static const __m128i backslash = _mm_set1_epi8('\\');
+
+		while (i + 16 <= size) {
+			__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
+			uint16_t mask = _mm_movemask_epi8(_mm_or_si128(
+				_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)));
+			if (mask != 0)
+				return i + CTZ16(mask);
+			i += 16;
+		}
+		return findStringDelimiterScalar(input, size, i);
+	}
+
+	inline size_t findEscapeCharSIMD16(const char* input, size_t size, size_t i) {
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i backslash = _mm_set1_epi8('\\');
+		const __m128i lastControl = _mm_set1_epi8(0x1F);
+
+		while (i + 16 <= size) {
+			__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
+			// Unsigned chunk <= 0x1F, there is no unsigned byte compare
+			__m128i control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, lastControl), chunk);
+			uint16_t mask = _mm_movemask_epi8(_mm_or_si128(control, _mm_or_si128(
+				_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash))));
+			if (mask != 0)
+				return i + CTZ16(mask);
+			i += 16;
+		}
+		return findEscapeCharScalar(input, size, i);
+	}
+
+	inline size_t findNestingCharSIMD16(const char* input, size_t size, size_t i) {
+		static const __m128i quote = _mm_set1_epi8('"');
+		static const __m128i slash = _mm_set1_epi8('/');
+		static const __m128i caseBit = _mm_set1_epi8(0x20);
+		static const __m128i braceOpen = _mm_set1_epi8('{');
+		static const __m128i braceClose = _mm_set1_epi8('}');
+
+		while (i + 16 <= size) {
+			__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
+			// '[' and ']' differ from '{' and '}' only by the 0x20 bit
+			__m128i folded = _mm_or_si128(chunk, caseBit);
+			uint16_t mask = _mm_movemask_epi8(_mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, slash)),
+				_mm_or_si128(_mm_cmpeq_epi8(folded, braceOpen), _mm_cmpeq_epi8(folded, braceClose))));
+			if (mask != 0)
+				return i + CTZ16(mask);
+			i += 16;
+		}
+		return findNestingCharScalar(input, size, i);
+	}
+#endif
+
+	using ScanKernel = size_t(*)(const char* input, size_t size, size_t i);
+
+	struct ScanKernels
+	{
+		ScanKernel skipWhitespace = skipWhitespaceScalar;
+		ScanKernel skipSpaces = skipSpacesScalar;
+		ScanKernel findStringDelimiter = findStringDelimiterScalar;
+		ScanKernel findEscapeChar = findEscapeCharScalar;
+		ScanKernel findNestingChar = findNestingCharScalar;
+	};
+
+	inline ScanKernels selectScanKernels(const CpuFeatures& features) {
+		ScanKernels kernels;
+#ifdef HAS_AVX512
+		if (features.avx512bw) {
+			kernels.skipWhitespace = skipWhitespaceSIMD64;
+			kernels.skipSpaces = skipSpacesSIMD64;
+			kernels.findStringDelimiter = findStringDelimiterSIMD64;
+			kernels.findEscapeChar = findEscapeCharSIMD64;
+			kernels.findNestingChar = findNestingCharSIMD64;
+			return kernels;
+		}
+#endif
+#ifdef HAS_AVX2
+		if (features.avx2) {
+			kernels.skipWhitespace = skipWhitespaceSIMD32;
+			kernels.skipSpaces = skipSpacesSIMD32;
+			kernels.findStringDelimiter = findStringDelimiterSIMD32;
+			kernels.findEscapeChar = findEscapeCharSIMD32;
+			kernels.findNestingChar = findNestingCharSIMD32;
+			return kernels;
+		}
+#endif
+#ifdef HAS_SSE2
+		if (features.sse2) {
+			kernels.skipWhitespace = skipWhitespaceSIMD16;
+			kernels.skipSpaces = skipSpacesSIMD16;
+			kernels.findStringDelimiter = findStringDelimiterSIMD16;
+			kernels.findEscapeChar = findEscapeCharSIMD16;
+			kernels.findNestingChar = findNestingCharSIMD16;
+		}
+#endif
+		return kernels;
+	}
+
+	inline const ScanKernels& scanKernels() {
+		static const ScanKernels kernels = selectScanKernels(cpuFeatures());
+		return kernels;
+	}
+
+	// Skips whitespace and comments, returns the index of the next significant character or size
+	// Most tokens are not preceded by whitespace, that case never reaches the indirect call
+	inline size_t skipWhitespace(const char* input, size_t size, size_t i) {
+		if (i < size && !isWhitespace(input[i]) && input[i] != commentStart) return i;
+		return scanKernels().skipWhitespace(input, size, i);
+	}
+
+	// Skips whitespace only, returns the index of the next non-whitespace character or size
+	inline size_t skipSpaces(const char* input, size_t size, size_t i) {
+		if (i < size && !isWhitespace(input[i])) return i;
+		return scanKernels().skipSpaces(input, size, i);
+	}
+
+	inline size_t findStringDelimiter(const char* input, size_t size, size_t i) {
+		return scanKernels().findStringDelimiter(input, size, i);
+	}
+
+	// Short runs, such as inline strings, are not worth the indirect call
+	inline size_t findEscapeChar(const char* input, size_t size, size_t i) {
+		if (size - i < 16) return findEscapeCharScalar(input, size, i);
+		return scanKernels().findEscapeChar(input, size, i);
+	}
+
+	inline size_t findNestingChar(const char* input, size_t size, size_t i) {
+		return scanKernels().findNestingChar(input, size, i);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,311 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+
+#include "JsonParser/Utils/SIMDUtils.h"
+#include "JsonParser/Utils/ScanUtils.h"
+
+namespace Json::Detail
+{
+	// Positions of every structural character ({}[]:,), string start and scalar start in the input
+	// The last entry is a sentinel equal to the input size
+	class StructuralIndex
+	{
+	private:
+		std::unique_ptr<uint32_t[]> m_positions;
+		size_t m_size = 0;
+		size_t m_capacity = 0;
+
+	public:
+		StructuralIndex() = default;
+
+		inline size_t size() const noexcept { return m_size; }
+		inline bool empty() const noexcept { return m_size == 0; }
+		inline const uint32_t* data() const noexcept { return m_positions.get(); }
+		inline uint32_t operator[](size_t i) const noexcept { return m_positions[i]; }
+
+		void reserve(size_t capacity)
+		{
+			if (capacity <= m_capacity) return;
+			auto positions = std::make_unique<uint32_t[]>(capacity);
+			if (m_size) std::memcpy(positions.get(), m_positions.get(), m_size * sizeof(uint32_t));
+			m_positions = std::move(positions);
+			m_capacity = capacity;
+		}
+
+		void clear() noexcept { m_size = 0; }
+
+		inline void push(uint32_t position)
+		{
+			if (m_size == m_capacity) reserve(m_capacity ? m_capacity * 2 : 64);
+			m_positions[m_size++] = position;
+		}
+
+		// Appends the positions of all set bits of a 64-byte block starting at base
+		inline void append(uint32_t base, uint64_t bits)
+		{
+			if (m_size + 64 > m_capacity) reserve(std::max(m_capacity * 2, m_size + 64));
+			uint32_t* out = m_positions.get() + m_size;
+			while (bits) {
+				*out++ = base + static_cast<uint32_t>(CTZ64(bits));
+				bits &= bits - 1;
+			}
+			m_size = out - m_positions.get();
+		}
+	};
+
+	// Stage 1 of the two-stage parser: classifies the input in 64-byte blocks into bitmasks and
+	// turns them into a structural index. Only strict JSON is recognised, comments are not
+	class StructuralIndexer
+	{
+	public:
+		struct BlockMasks
+		{
+			uint64_t quote;
+			uint64_t backslash;
+			uint64_t whitespace;
+			uint64_t op;
+		};
+
+		static constexpr size_t blockSize = 64;
+
+	private:
+		static constexpr uint64_t evenBits = 0x5555555555555555ULL;
+
+		struct State
+		{
+			uint64_t prevEscaped = 0;
+			uint64_t prevInString = 0;
+			uint64_t prevScalar = 0;
+		};
+
+#ifdef HAS_AVX512
+		// The whole block fits one register and every comparison lands directly in a mask register
+		JSON_TARGET_AVX512 static inline BlockMasks classifyAVX512(const char* block)
+		{
+			const __m512i quote = _mm512_set1_epi8('"');
+			const __m512i backslash = _mm512_set1_epi8('\\');
+			const __m512i caseBit = _mm512_set1_epi8(0x20);
+			const __m512i braceOpen = _mm512_set1_epi8('{');
+			const __m512i braceClose = _mm512_set1_epi8('}');
+			const __m512i comma = _mm512_set1_epi8(',');
+			const __m512i colon = _mm512_set1_epi8(':');
+
+			__m512i chunk = _mm512_loadu_si512(block);
+			// '[' and ']' differ from '{' and '}' only by the 0x20 bit
+			__m512i folded = _mm512_or_si512(chunk, caseBit);
+
+			BlockMasks masks;
+			masks.quote = _mm512_cmpeq_epi8_mask(chunk, quote);
+			masks.backslash = _mm512_cmpeq_epi8_mask(chunk, backslash);
+			masks.whitespace = whitespaceMask64(chunk);
+			masks.op = _mm512_cmpeq_epi8_mask(folded, braceOpen) | _mm512_cmpeq_epi8_mask(folded, braceClose) |
+				_mm512_cmpeq_epi8_mask(chunk, comma) | _mm512_cmpeq_epi8_mask(chunk, colon);
+			return masks;
+		}
+#endif
+
+#ifdef HAS_AVX2
+		JSON_TARGET_AVX2 static inline BlockMasks classifyAVX2(const char* block)
+		{
+			const __m256i quote = _mm256_set1_epi8('"');
+			const __m256i backslash = _mm256_set1_epi8('\\');
+			const __m256i space = _mm256_set1_epi8(' ');
+			const __m256i tab = _mm256_set1_epi8('\t');
+			const __m256i cr = _mm256_set1_epi8('\r');
+			const __m256i lf = _mm256_set1_epi8('\n');
+			const __m256i caseBit = _mm256_set1_epi8(0x20);
+			const __m256i braceOpen = _mm256_set1_epi8('{');
+			const __m256i braceClose = _mm256_set1_epi8('}');
+			const __m256i comma = _mm256_set1_epi8(',');
+			const __m256i colon = _mm256_set1_epi8(':');
+
+			BlockMasks masks{};
+			for (size_t k = 0; k < blockSize; k += 32) {
+				__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + k));
+				// '[' and ']' differ from '{' and '}' only by the 0x20 bit
+				__m256i folded = _mm256_or_si256(chunk, caseBit);
+
+				uint64_t q = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote)));
+				uint64_t b = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, backslash)));
+				uint64_t w = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(
+					_mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+					_mm256_or_si256(_mm256_cmpeq_epi8(chunk, cr), _mm256_cmpeq_epi8(chunk, lf)))));
+				uint64_t o = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(
+					_mm256_or_si256(_mm256_cmpeq_epi8(folded, braceOpen), _mm256_cmpeq_epi8(folded, braceClose)),
+					_mm256_or_si256(_mm256_cmpeq_epi8(chunk, comma), _mm256_cmpeq_epi8(chunk, colon)))));
+
+				masks.quote |= q << k;
+				masks.backslash |= b << k;
+				masks.whitespace |= w << k;
+				masks.op |= o << k;
+			}
+			return masks;
+		}
+#endif
+
+#ifdef HAS_SSE2
+		static inline BlockMasks classifySSE2(const char* block)
+		{
+			const __m128i quote = _mm_set1_epi8('"');
+			const __m128i backslash = _mm_set1_epi8('\\');
+			const __m128i space = _mm_set1_epi8(' ');
+			const __m128i tab = _mm_set1_epi8('\t');
+			const __m128i cr = _mm_set1_epi8('\r');
+			const __m128i lf = _mm_set1_epi8('\n');
+			const __m128i caseBit = _mm_set1_epi8(0x20);
+			const __m128i braceOpen = _mm_set1_epi8('{');
+			const __m128i braceClose = _mm_set1_epi8('}');
+			const __m128i comma = _mm_set1_epi8(',');
+			const __m128i colon = _mm_set1_epi8(':');
+
+			BlockMasks masks{};
+			for (size_t k = 0; k < blockSize; k += 16) {
+				__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + k));
+				// '[' and ']' differ from '{' and '}' only by the 0x20 bit
+				__m128i folded = _mm_or_si128(chunk, caseBit);
+
+				uint64_t q = static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)));
+				uint64_t b = static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash)));
+				uint64_t w = static_cast<uint16_t>(_mm_movemask_epi8(_mm_or_si128(
+					_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+					_mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, lf)))));
+				uint64_t o = static_cast<uint16_t>(_mm_movemask_epi8(_mm_or_si128(
+					_mm_or_si128(_mm_cmpeq_epi8(folded, braceOpen), _mm_cmpeq_epi8(folded, braceClose)),
+					_mm_or_si128(_mm_cmpeq_epi8(chunk, comma), _mm_cmpeq_epi8(chunk, colon)))));
+
+				masks.quote |= q << k;
+				masks.backslash |= b << k;
+				masks.whitespace |= w << k;
+				masks.op |= o << k;
+			}
+			return masks;
+		}
+#endif
+
+		static inline BlockMasks classifyScalar(const char* block)
+		{
+			BlockMasks masks{};
+			for (size_t k = 0; k < blockSize; ++k) {
+				uint64_t bit = uint64_t(1) << k;
+				switch (block[k]) {
+				case '"': masks.quote |= bit; break;
+				case '\\': masks.backslash |= bit; break;
+				case ' ': case '\t': case '\r': case '\n': masks.whitespace |= bit; break;
+				case '{': case '}': case '[': case ']': case ':': case ',': masks.op |= bit; break;
+				default: break;
+				}
+			}
+			return masks;
+		}
+
+		// Marks the characters preceded by an odd-length run of backslashes
+		static inline uint64_t findEscaped(uint64_t backslash, uint64_t& prevEscaped)
+		{
+			if (!backslash) {
+				uint64_t escaped = prevEscaped;
+				prevEscaped = 0;
+				return escaped;
+			}
+			backslash &= ~prevEscaped;
+			uint64_t followsEscape = backslash << 1 | prevEscaped;
+			uint64_t oddSequenceStarts = backslash & ~evenBits & ~followsEscape;
+			uint64_t sequencesStartingOnEvenBits = oddSequenceStarts + backslash;
+			prevEscaped = sequencesStartingOnEvenBits < oddSequenceStarts;
+			uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+			return (evenBits ^ invertMask) & followsEscape;
+		}
+
+		// Bit i of the result is the xor of bits 0..i of the input
+		static inline uint64_t prefixXor(uint64_t bits)
+		{
+			bits ^= bits << 1;
+			bits ^= bits << 2;
+			bits ^= bits << 4;
+			bits ^= bits << 8;
+			bits ^= bits << 16;
+			bits ^= bits << 32;
+			return bits;
+		}
+
+		using Classifier = BlockMasks(*)(const char* block);
+
+		static Classifier selectClassifier(const CpuFeatures& features)
+		{
+#ifdef HAS_AVX512
+			if (features.avx512bw) return classifyAVX512;
+#endif
+#ifdef HAS_AVX2
+			if (features.avx2) return classifyAVX2;
+#endif
+#ifdef HAS_SSE2
+			if (features.sse2) return classifySSE2;
+#endif
+			return classifyScalar;
+		}
+
+		// Picked once per process from the CPU features
+		static Classifier classifier()
+		{
+			static const Classifier selected = selectClassifier(cpuFeatures());
+			return selected;
+		}
+
+		static inline uint64_t indexBlock(const BlockMasks& masks, State& state)
+		{
+			uint64_t escaped = findEscaped(masks.backslash, state.prevEscaped);
+			uint64_t quote = masks.quote & ~escaped;
+			// Opening quotes and string contents are set, closing quotes are not
+			uint64_t inString = prefixXor(quote) ^ state.prevInString;
+			state.prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+			uint64_t scalar = ~(masks.op | masks.whitespace);
+			uint64_t nonQuoteScalar = scalar & ~quote;
+			uint64_t followsNonQuoteScalar = nonQuoteScalar << 1 | state.prevScalar;
+			state.prevScalar = nonQuoteScalar >> 63;
+
+			uint64_t stringTail = inString ^ quote;
+			return (masks.op | (scalar & ~followsNonQuoteScalar)) & ~stringTail;
+		}
+
+	public:
+		static inline BlockMasks classify(const char* block)
+		{
+			return classifier()(block);
+		}
+
+		static void index(std::string_view input, StructuralIndex& index)
+		{
+			if (input.size() >= std::numeric_limits<uint32_t>::max())
+				throw std::runtime_error("Input too large for structural index");
+
+			index.clear();
+			// Typical JSON has a structural character every 4 to 8 bytes
+			index.reserve(input.size() / 4 + blockSize);
+
+			State state;
+			const Classifier classify = classifier();
+			const char* data = input.data();
+			const size_t size = input.size();
+			size_t base = 0;
+			for (; base + blockSize <= size; base += blockSize)
+				index.append(static_cast<uint32_t>(base), indexBlock(classify(data + base), state));
+
+			if (base < size) {
+				char tail[blockSize];
+				std::memset(tail, ' ', blockSize);
+				std::memcpy(tail, data + base, size - base);
+				index.append(static_cast<uint32_t>(base), indexBlock(classify(tail), state));
+			}
+
+			if (state.prevInString) throw std::runtime_error("Unterminated string");
+			index.push(static_cast<uint32_t>(size));
+		}
+	};
+}
\ No newline at end of file
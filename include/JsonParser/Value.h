@@ -1,21 +1,31 @@
 #pragma once
 #include <string>
+#include <algorithm>
+#include <atomic>
 #include <vector>
-#include <variant>
-#include <unordered_map>
+#include <memory_resource>
+#include <new>
 #include <span>
 #include <stdexcept>
 #include <string_view>
 #include <limits>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
 
 #include "JsonParser/Concepts.h"
+#include "JsonParser/Array.h"
+#include "JsonParser/InternPool.h"
+#include "JsonParser/Object.h"
+#include "JsonParser/Serializer.h"
+#include "JsonParser/Sink.h"
+#include "JsonParser/String.h"
 #include "JsonParser/Utils/Macros.h"
 #include "JsonParser/ContainerParser.h"
 #include "JsonParser/StreamParser.h"
 #include "JsonParser/StrictContainerParser.h"
 #include "JsonParser/StrictStreamParser.h"
+#include "JsonParser/StructuralParser.h"
 
 namespace Json
 {
@@ -39,249 +49,799 @@ namespace Json
 			Null
 		};
 
+		// Containers and strings allocate from the global heap unless a Value is created from a memory_resource
+		// (see the constructors and parsers taking one, array(resource), object(resource) and Document)
+		using Array = BasicArray<Value>;
 
-		struct TransparentObjectHash {
-			using is_transparent = void;
+		// Keys are Strings so that a Document can borrow them from its input
+		using Object = BasicObject<Value>;
 
-			size_t operator()(std::string_view sv) const noexcept {
-				return std::hash<std::string_view>{}(sv);
-			}
+	protected:
+		// Every packed container keeps the array of Values the const accessors built from it, if any (see
+		// arrayOfValues), and frees it with itself. Copies start without one
+		struct Unpacked {
+			mutable std::atomic<Array*> values = nullptr;
 
-			size_t operator()(const std::string& s) const noexcept {
-				return std::hash<std::string_view>{}(s);
-			}
+			Unpacked() noexcept = default;
+			Unpacked(const Unpacked&) noexcept {}
+			~Unpacked() { free(); }
 
-			size_t operator()(const char* s) const noexcept {
-				return std::hash<std::string_view>{}(s);
+			void free() noexcept {
+				if (Array* array = values.exchange(nullptr, std::memory_order_acq_rel)) destroy(array);
 			}
 		};
 
-		struct TransparentObjectEqual {
-			using is_transparent = void;
+		template<typename T>
+		struct PackedArray : BasicArray<T>, Unpacked {
+			using BasicArray<T>::BasicArray;
+		};
+
+		using IntegerArray = PackedArray<int64_t>;
+		using NumberArray = PackedArray<double>;
 
-			bool operator()(std::string_view lhs,
-							std::string_view rhs) const noexcept {
-				return lhs == rhs;
-			}
+		// Same-shaped objects of an array stored column by column (see pushBackColumnar),
+		// one array per key which is packed when the key's values are numbers of one type
+		struct Table : Unpacked {
+			BasicArray<String> keys;
+			BasicArray<Value> columns;
+			size_t rows = 0;
+
+			explicit Table(std::pmr::memory_resource* resource = nullptr) : keys(resource), columns(resource) {}
 		};
 
-		using Object = std::unordered_map<std::string, Value,
-			TransparentObjectHash, TransparentObjectEqual>;
+		// Payload of every type but String, with the tag in the same byte as String's control byte
+		struct Cell {
+			union {
+				Array* array;
+				IntegerArray* integers;
+				NumberArray* numbers;
+				Table* table;
+				Object* object;
+				std::string* text;
+				bool boolean;
+				int64_t integer;
+				double number;
+			};
+			char padding[7];
+			uint8_t tag;
+		};
 
-		using Storage = std::variant<std::vector<Value>*, Object*, std::string*, bool, int64_t, double, std::nullptr_t>;
+		static constexpr uint8_t tagMask = 0xE0;
+		static constexpr uint8_t typeMask = 0x07;
+		// Arrays whose elements are all integers or all doubles can be stored packed and arrays of same-shaped
+		// objects as a Table, still reported as Type::Array
+		static constexpr uint8_t arrayTag = String::reservedTags | static_cast<uint8_t>(Type::Array);
+		static constexpr uint8_t integerArrayTag = arrayTag | 0x08;
+		static constexpr uint8_t numberArrayTag = arrayTag | 0x10;
+		static constexpr uint8_t tableTag = arrayTag | 0x18;
+		// A string handed out as a mutable std::string by asString(), still reported as Type::String
+		static constexpr uint8_t boxedStringTag = String::reservedTags | static_cast<uint8_t>(Type::String);
+		static constexpr std::nullptr_t null = nullptr;
 
-	protected:
-		Storage m_value;
+		// 16 bytes: a String (short strings inline, see String) or a Cell tagged reservedTags | Type
+		// Both are trivially relocatable, moves copy the bytes
+		union {
+			String m_string;
+			Cell m_cell;
+		};
+
+		inline uint8_t tag() const noexcept { return reinterpret_cast<const unsigned char*>(this)[15]; }
+
+		inline void setTag(Type type) noexcept { m_cell.tag = static_cast<uint8_t>(String::reservedTags | static_cast<uint8_t>(type)); }
+
+		inline void setArray(Array* array) noexcept { m_cell.array = array; setTag(Type::Array); }
+		inline void setArray(IntegerArray* integers) noexcept { m_cell.integers = integers; m_cell.tag = integerArrayTag; }
+		inline void setArray(NumberArray* numbers) noexcept { m_cell.numbers = numbers; m_cell.tag = numberArrayTag; }
+		inline void setArray(Table* table) noexcept { m_cell.table = table; m_cell.tag = tableTag; }
+		inline void setObject(Object* object) noexcept { m_cell.object = object; setTag(Type::Object); }
+
+		template<typename T>
+		inline void setContainer(T* container) noexcept {
+			if constexpr (std::same_as<T, Object>) setObject(container);
+			else setArray(container);
+		}
+
+		// Calls f with the container of an array or object Value
+		template<typename F>
+		inline decltype(auto) withContainer(F f) const {
+			if (tag() == integerArrayTag) return f(m_cell.integers);
+			if (tag() == numberArrayTag) return f(m_cell.numbers);
+			if (tag() == tableTag) return f(m_cell.table);
+			if (tag() == arrayTag) return f(m_cell.array);
+			return f(m_cell.object);
+		}
+
+		// In front of every heap container: copies of a Value share its container until one of them changes it
+		struct Counted {
+			std::atomic<uint32_t> references = 1;
+			// Set once a mutable reference into the container was handed out, which copies must not see change,
+			// so they copy it from then on
+			std::atomic<bool> exposed = false;
+		};
+
+		static constexpr size_t countedSize = 16;
+
+		template<typename T>
+		static Counted* counted(T* container) noexcept {
+			return std::launder(reinterpret_cast<Counted*>(reinterpret_cast<char*>(container) - countedSize));
+		}
+
+		// A heap container behind its Counted header, also used for heap copies of containers from any resource
+		template<typename T, typename... Args>
+		static T* createCounted(Args&&... args) {
+			char* memory = static_cast<char*>(::operator new(countedSize + sizeof(T)));
+			new (memory) Counted();
+			try {
+				return new (memory + countedSize) T(std::forward<Args>(args)...);
+			}
+			catch (...) {
+				::operator delete(memory, countedSize + sizeof(T));
+				throw;
+			}
+		}
+
+		// The container itself is allocated from the resource it uses for its elements,
+		// so it can be freed without knowing where it came from
+		template<typename T, typename... Args>
+		static T* create(std::pmr::memory_resource* resource, Args&&... args) {
+			if (!resource) return createCounted<T>(std::forward<Args>(args)...);
+			void* memory = resource->allocate(sizeof(T), alignof(T));
+			try {
+				return new (memory) T(std::forward<Args>(args)..., resource);
+			}
+			catch (...) {
+				resource->deallocate(memory, sizeof(T), alignof(T));
+				throw;
+			}
+		}
+
+		template<typename T>
+		static std::pmr::memory_resource* resourceOf(const BasicArray<T>& array) noexcept { return array.resource(); }
+		static std::pmr::memory_resource* resourceOf(const Object& object) noexcept { return object.resource(); }
+		static std::pmr::memory_resource* resourceOf(const Table& table) noexcept { return table.keys.resource(); }
+
+		template<typename T>
+		static void destroy(T* container) noexcept {
+			std::pmr::memory_resource* resource = resourceOf(*container);
+			if (!resource) {
+				Counted* header = counted(container);
+				if (header->references.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+				container->~T();
+				header->~Counted();
+				::operator delete(header, countedSize + sizeof(T));
+				return;
+			}
+			container->~T();
+			resource->deallocate(container, sizeof(T), alignof(T));
+		}
 
 	public:
-		Value() : m_value(nullptr) {};
+		Value() noexcept : m_cell() { setTag(Type::Null); };
 
+		// Initializer lists, strings and copies taking a resource allocate everything they hold from it
 		template<typename T>
-		Value(std::initializer_list<T> values) requires std::convertible_to<T, bool>
+		Value(std::initializer_list<T> values, std::pmr::memory_resource* resource = nullptr) requires std::convertible_to<T, bool>
 			|| std::convertible_to<T, double>
 			|| std::convertible_to<T, int>
 			|| std::convertible_to<T, std::string>
 			|| std::convertible_to<T, std::string_view>
 			|| std::convertible_to<T, const char*>
-			|| std::convertible_to<T, std::nullptr_t> {
-			m_value = new std::vector<Value>();
-			auto& arr = *std::get<std::vector<Value>*>(m_value);
+			|| std::convertible_to<T, std::nullptr_t> : m_cell() {
+			setArray(create<Array>(resource));
+			auto& arr = *m_cell.array;
 			arr.reserve(values.size());
 			for (auto& val : values) {
-				arr.emplace_back(std::move(val));
+				if constexpr (std::convertible_to<T, std::string_view> && !std::same_as<T, std::nullptr_t>) arr.emplace_back(std::string_view(val), resource);
+				else arr.emplace_back(std::move(val));
 			}
 		};
-		Value(std::string_view value) {
-			m_value = new std::string(value);
-		}
-		Value(const std::string& value) {
-			m_value = new std::string(value);
-		}
+		Value(std::string_view value) : m_string(value) {}
+		Value(const std::string& value) : m_string(value) {}
 		template<size_t N>
-		Value(const char (&value)[N]) {
-			m_value = new std::string(value);
-		}
+		Value(const char (&value)[N]) : m_string(value) {}
+		Value(String value) noexcept : m_string(std::move(value)) {}
+		Value(std::string_view value, std::pmr::memory_resource* resource) : m_string(value, resource) {}
+		Value(const std::string& value, std::pmr::memory_resource* resource) : m_string(std::string_view(value), resource) {}
+		template<size_t N>
+		Value(const char (&value)[N], std::pmr::memory_resource* resource) : m_string(std::string_view(value), resource) {}
 
 		template<typename T>
-		Value(T value) requires std::floating_point<T>
+		Value(T value) requires std::floating_point<T> : m_cell()
 		{
-			m_value = value;
+			m_cell.number = value;
+			setTag(Type::Number);
 		}
 
 		template<typename T>
-		Value(T value) requires std::integral<T> && (!std::same_as<T, bool>)
+		Value(T value) requires std::integral<T> && (!std::same_as<T, bool>) : m_cell()
 		{
-			m_value = value;
+			m_cell.integer = value;
+			setTag(Type::Integer);
 		}
 
 		template<typename T>
-		Value(T value) requires std::same_as<T, bool> {
-			m_value = value;
+		Value(T value) requires std::same_as<T, bool> : m_cell() {
+			m_cell.boolean = value;
+			setTag(Type::Bool);
 		}
-		Value(std::initializer_list<std::pair<std::string, Value>> values) {
-			m_value = new Object();
-			auto& map = *std::get<Object*>(m_value);
+		Value(std::initializer_list<std::pair<std::string, Value>> values, std::pmr::memory_resource* resource = nullptr) : m_cell() {
+			setObject(create<Object>(resource));
+			auto& map = *m_cell.object;
 			map.reserve(values.size());
 			for (auto& pair : values) {
-				map.emplace(pair.first, pair.second);
+				map.try_emplace(std::string_view(pair.first), pair.second, resource);
 			}
 		}
-		Value(std::nullptr_t) {
-			m_value = nullptr;
+		Value(std::nullptr_t) noexcept : Value() {}
+
+		Type getType() const noexcept {
+			const uint8_t tag = this->tag();
+			return (tag & tagMask) == String::reservedTags ? static_cast<Type>(tag & typeMask) : Type::String;
 		}
-		Type getType() const { return static_cast<Type>(m_value.index()); }
 
 		template<Type T>
-		const auto& get() const {
+		decltype(auto) get() const {
 #ifndef NODEBUG
-			switch (getType()) {
-			case T:
-				return std::get<Detail::EnumToTypeTrait<T>::Type>(m_value);
-			default:
-				JSON_VERIFY(false, "Type mismatch");
-			}
-#else
-            return std::get<Detail::EnumToTypeTrait<T>::Type>(m_value);
+			JSON_VERIFY(getType() == T, "Type mismatch");
 #endif
+			// Read-only like the const asArray and asObject, the container is neither detached nor unpacked
+			if constexpr (T == Type::Array) return &arrayOfValues();
+			else if constexpr (T == Type::Object) return static_cast<const Object*>(m_cell.object);
+			else if constexpr (T == Type::String) return asStringView();
+			else if constexpr (T == Type::Bool) return m_cell.boolean;
+			else if constexpr (T == Type::Integer) return m_cell.integer;
+			else if constexpr (T == Type::Number) return m_cell.number;
+			else return null;
 		}
 
-		~Value() {
+	private:
+		// Frees the payload, the Value has to be reinitialized afterwards
+		void release() noexcept {
 			switch (getType()) {
 			case Type::Array:
-				delete std::get<std::vector<Value>*>(m_value);
-				break;
 			case Type::Object:
-				delete std::get<Object*>(m_value);
+				withContainer([](auto* container) { destroy(container); });
 				break;
 			case Type::String:
-				delete std::get<std::string*>(m_value);
+				if (tag() == boxedStringTag) delete m_cell.text;
+				else m_string.~String();
 				break;
 			default:
 				break;
 			};
 		}
 
+		// Any array that is not stored as Values
+		inline bool isPacked() const noexcept { return tag() != arrayTag && getType() == Type::Array; }
+
+		// Deep copies into resource for the allocator-extended copy constructor, the copy is set before it is
+		// filled so that it is freed if an element throws
+		template<typename T>
+		void copyContainer(const BasicArray<T>& source, std::pmr::memory_resource* resource) {
+			using Copy = std::conditional_t<std::same_as<T, Value>, Array, PackedArray<T>>;
+			Copy* copy = create<Copy>(resource);
+			setArray(copy);
+			copy->reserve(source.size());
+			for (const T& element : source) {
+				if constexpr (std::same_as<T, Value>) copy->emplace_back(element, resource);
+				else copy->emplace_back(element);
+			}
+		}
+
+		void copyContainer(const Table& source, std::pmr::memory_resource* resource) {
+			Table* copy = create<Table>(resource);
+			setArray(copy);
+			copy->keys.reserve(source.keys.size());
+			for (const String& key : source.keys) copy->keys.emplace_back(key, resource);
+			copy->columns.reserve(source.columns.size());
+			for (const Value& column : source.columns) copy->columns.emplace_back(column, resource);
+			copy->rows = source.rows;
+		}
+
+		void copyContainer(const Object& source, std::pmr::memory_resource* resource) {
+			Object* copy = create<Object>(resource);
+			setObject(copy);
+			const Shape* shape = source.shape();
+			if (shape && !shape->resource()) {
+				Value values[Shape::maxKeys];
+				size_t i = 0;
+				for (auto&& [key, value] : source) values[i++] = Value(value, resource);
+				copy->assign(shape, values);
+				return;
+			}
+			copy->reserve(source.size());
+			for (auto&& [key, value] : source) copy->try_emplace(String(key, resource), value, resource);
+		}
+
+		// Whether other Values share the heap container of this array or object
+		bool isShared() const noexcept {
+			return withContainer([](auto* container) {
+				return !resourceOf(*container) && counted(container)->references.load(std::memory_order_acquire) > 1;
+			});
+		}
+
+		// Gives the array or object a container of its own before it changes, copying the one other Values share
+		// expose marks it as handed out by reference, so later copies copy it instead of sharing
+		Value& detach(bool expose) {
+			withContainer([this, expose](auto* container) {
+				using T = std::remove_pointer_t<decltype(container)>;
+				if (resourceOf(*container)) return;
+				if (counted(container)->references.load(std::memory_order_acquire) > 1) {
+					T* copy = createCounted<T>(*container);
+					destroy(container);
+					setContainer(copy);
+					container = copy;
+				}
+				if (expose) counted(container)->exposed.store(true, std::memory_order_relaxed);
+			});
+			dropValues();
+			return *this;
+		}
+
+		// For builders filling a Value nothing else refers to yet: unlike asArray and asObject they do not expose
+		// the container, so copies of the result still share it
+		template<typename, bool> friend class ValueBuilder;
+		Array& buildingArray() { return *unpack().m_cell.array; }
+		Object& buildingObject() { return *m_cell.object; }
+
+		// Writes columnar arrays straight from their Table
+		template<typename, OutputBuffer> friend class Serializer;
+
+		// Element index of an array column, moved out of generic columns unless copy is set or they are shared,
+		// copies allocate from the column's resource
+		Value takeElement(size_t index, bool copy) {
+			if (tag() == integerArrayTag) return Value((*m_cell.integers)[index]);
+			if (tag() == numberArrayTag) return Value((*m_cell.numbers)[index]);
+			if (copy || isShared()) return Value((*m_cell.array)[index], resourceOf(*m_cell.array));
+			return std::move((*m_cell.array)[index]);
+		}
+
+		std::atomic<Array*>& unpackedValues() const noexcept {
+			if (tag() == integerArrayTag) return m_cell.integers->values;
+			if (tag() == numberArrayTag) return m_cell.numbers->values;
+			return m_cell.table->values;
+		}
+
+		// The elements of a packed array or Table as an array of Values allocated from the same resource, moved out
+		// of the Table's generic columns unless copy is set. Keys borrowed by a Table stay borrowed in the objects
+		Array* toValues(bool copy) {
+			std::pmr::memory_resource* resource = tag() == integerArrayTag ? resourceOf(*m_cell.integers)
+				: tag() == numberArrayTag ? resourceOf(*m_cell.numbers) : resourceOf(*m_cell.table);
+			Array* array = create<Array>(resource);
+			auto fill = [array](const auto& packed) {
+				array->reserve(packed.size());
+				for (auto value : packed) array->emplace_back(value);
+			};
+			// Rows share one Shape unless they have too many keys
+			const Shape* shape = nullptr;
+			auto fillRows = [array, resource, copy, &shape](Table& table) {
+				array->reserve(table.rows);
+				const size_t keys = table.keys.size();
+				if (keys > Shape::maxKeys || table.rows == 0) {
+					for (size_t row = 0; row < table.rows; ++row) {
+						Object& object = *array->emplace_back(Value::object(resource)).m_cell.object;
+						object.reserve(keys);
+						for (size_t i = 0; i < keys; ++i) object.try_emplace(table.keys[i].borrowOrCopy(), table.columns[i].takeElement(row, copy));
+					}
+					return;
+				}
+				shape = Shape::create({ table.keys.data(), keys }, resource);
+				Value values[Shape::maxKeys];
+				for (size_t row = 0; row < table.rows; ++row) {
+					for (size_t i = 0; i < keys; ++i) values[i] = table.columns[i].takeElement(row, copy);
+					Object& object = *array->emplace_back(Value::object(resource)).m_cell.object;
+					if (keys) object.assign(shape, values);
+				}
+			};
+			try {
+				if (tag() == integerArrayTag) fill(*m_cell.integers);
+				else if (tag() == numberArrayTag) fill(*m_cell.numbers);
+				else fillRows(*m_cell.table);
+			}
+			catch (...) {
+				Shape::release(shape);
+				destroy(array);
+				throw;
+			}
+			Shape::release(shape);
+			return array;
+		}
+
+		// Turns a packed array or Table into an array of Values, a Table other Values share is left intact
+		Value& unpack() {
+			if (!isPacked()) return *this;
+			const bool shared = isShared();
+			Array* array = shared ? nullptr : unpackedValues().exchange(nullptr, std::memory_order_acq_rel);
+			if (!array) array = toValues(shared);
+			release();
+			setArray(array);
+			return *this;
+		}
+
+		void append(Value&& value) {
+			dropValues();
+			if (tag() == integerArrayTag && value.isInteger()) m_cell.integers->push_back(value.m_cell.integer);
+			else if (tag() == numberArrayTag && value.isNumber()) m_cell.numbers->push_back(value.m_cell.number);
+			else if (tag() == tableTag && value.isObject()) appendRow(value);
+			else unpack().m_cell.array->push_back(std::move(value));
+		}
+
+		template<typename T>
+		inline void appendNumber(T value) {
+			if (tag() == arrayTag && m_cell.array->empty()) {
+				using Packed = std::conditional_t<std::same_as<T, int64_t>, IntegerArray, NumberArray>;
+				Packed* packed = create<Packed>(resourceOf(*m_cell.array));
+				destroy(m_cell.array);
+				setArray(packed);
+			}
+			append(Value(value));
+		}
+
+		// Moves the members of row into the columns and leaves it an empty object,
+		// or unpacks the Table and moves the whole row when its keys differ
+		void appendRow(Value& row) {
+			Table& table = *m_cell.table;
+			Object& object = *row.m_cell.object;
+			if (table.rows == 0 && table.keys.empty()) {
+				std::pmr::memory_resource* resource = resourceOf(table);
+				table.keys.reserve(object.size());
+				table.columns.reserve(object.size());
+				for (const auto& [key, value] : object) {
+					table.keys.push_back(key.borrowOrCopy());
+					table.columns.push_back(Value::array(resource));
+				}
+			}
+			else if (object.size() != table.keys.size() || !std::equal(table.keys.begin(), table.keys.end(), object.begin(),
+				[](const String& key, const auto& member) { return key == member.first; })) {
+				unpack().m_cell.array->push_back(std::move(row));
+				return;
+			}
+
+			size_t column = 0;
+			for (auto& [key, value] : object) {
+				if (value.isInteger()) table.columns[column].appendNumber(value.m_cell.integer);
+				else if (value.isNumber()) table.columns[column].appendNumber(value.m_cell.number);
+				else table.columns[column].append(std::move(value));
+				++column;
+			}
+			++table.rows;
+			object.clear();
+		}
+
+		// Const access cannot unpack without changing the Value under its other readers, so the first const read of a
+		// packed or columnar array as Values builds a copy of its elements, which it keeps until it changes
+		// Concurrent readers may each build one, the first published is kept and the others are freed
+		const Array& arrayOfValues() const {
+			JSON_VERIFY(getType() == Type::Array, "Type mismatch");
+			if (!isPacked()) return *m_cell.array;
+			std::atomic<Array*>& values = unpackedValues();
+			Array* array = values.load(std::memory_order_acquire);
+			if (array) return *array;
+			Array* built = const_cast<Value*>(this)->toValues(true);
+			if (values.compare_exchange_strong(array, built, std::memory_order_acq_rel, std::memory_order_acquire)) return *built;
+			destroy(built);
+			return *array;
+		}
+
+		// The copy arrayOfValues built no longer matches once the elements change
+		void dropValues() noexcept {
+			if (tag() == integerArrayTag) m_cell.integers->free();
+			else if (tag() == numberArrayTag) m_cell.numbers->free();
+			else if (tag() == tableTag) m_cell.table->free();
+		}
+
+		// Packed arrays are compared directly when both sides have the same kind, otherwise through unpacked copies
+		template<typename Compare>
+		bool compareArrays(const Value& other, Compare compare) const {
+			JSON_VERIFY(other.getType() == Type::Array, "Type mismatch");
+			if (tag() == other.tag() && tag() != tableTag) {
+				if (tag() == integerArrayTag) return compare(*m_cell.integers, *other.m_cell.integers);
+				if (tag() == numberArrayTag) return compare(*m_cell.numbers, *other.m_cell.numbers);
+				return compare(*m_cell.array, *other.m_cell.array);
+			}
+			Value lhs = *this, rhs = other;
+			return compare(*lhs.unpack().m_cell.array, *rhs.unpack().m_cell.array);
+		}
+
+		// Takes over other's bytes and leaves it null
+		void relocate(Value& other) noexcept {
+			std::memcpy(static_cast<void*>(this), static_cast<const void*>(&other), sizeof(Value));
+			new (&other.m_cell) Cell();
+			other.setTag(Type::Null);
+		}
+
+	public:
+		~Value() {
+			release();
+		}
+
 		Value(const Value& other) {
 			switch (other.getType()) {
 			case Type::Array:
-				m_value = new std::vector<Value>(*std::get<std::vector<Value>*>(other.m_value));
+			case Type::Object:
+				// Heap containers are shared until one side changes (see detach), arena ones are copied to the heap
+				new (&m_cell) Cell();
+				other.withContainer([this](auto* container) {
+					using T = std::remove_pointer_t<decltype(container)>;
+					if (!resourceOf(*container) && !counted(container)->exposed.load(std::memory_order_relaxed)) {
+						counted(container)->references.fetch_add(1, std::memory_order_relaxed);
+						setContainer(container);
+					}
+					else setContainer(createCounted<T>(*container));
+				});
+				break;
+			case Type::String:
+				// Boxed strings are only boxed for the Value that handed them out
+				if (other.tag() == boxedStringTag) new (&m_string) String(*other.m_cell.text);
+				else new (&m_string) String(other.m_string);
+				break;
+			default:
+				new (&m_cell) Cell(other.m_cell);
 				break;
+			}
+		}
+
+		// A deep copy allocating from resource, which has to outlive it, or a plain copy for nullptr
+		// Heap shapes stay shared, the keys of any other object are copied into resource
+		Value(const Value& other, std::pmr::memory_resource* resource) : Value() {
+			if (!resource) {
+				*this = other;
+				return;
+			}
+			switch (other.getType()) {
+			case Type::Array:
 			case Type::Object:
-				m_value = new Object(*std::get<Object*>(other.m_value));
+				other.withContainer([this, resource](const auto* container) { copyContainer(*container, resource); });
 				break;
 			case Type::String:
-				m_value = new std::string(*std::get<std::string*>(other.m_value));
+				if (other.tag() == boxedStringTag) new (&m_string) String(std::string_view(*other.m_cell.text), resource);
+				else new (&m_string) String(other.m_string, resource);
 				break;
 			default:
-				m_value = other.m_value;
+				m_cell = other.m_cell;
 				break;
 			}
 		}
 
 		Value& operator=(const Value& other) {
 			if (this != &other) {
-				this->~Value();
-				switch (other.getType()) {
-				case Type::Array:
-					m_value = new std::vector<Value>(*std::get<std::vector<Value>*>(other.m_value));
-					break;
-				case Type::Object:
-					m_value = new Object(*std::get<Object*>(other.m_value));
-					break;
-				case Type::String:
-					m_value = new std::string(*std::get<std::string*>(other.m_value));
-					break;
-				default:
-					m_value = other.m_value;
-					break;
-				}
+				Value copy(other);
+				*this = std::move(copy);
 			}
 			return *this;
 		}
 
 		Value(Value&& other) noexcept {
-			m_value = std::move(other.m_value);
-			other.m_value = nullptr;
+			relocate(other);
 		}
 		Value& operator=(Value&& other) noexcept {
 			if (this != &other) {
-				this->~Value();
-				m_value = std::move(other.m_value);
-				other.m_value = nullptr;
+				release();
+				relocate(other);
 			}
 			return *this;
 		}
 
-		static Value array(std::initializer_list<Value> values = {}) {
+		static Value array(std::initializer_list<Value> values = {}, std::pmr::memory_resource* resource = nullptr) {
 			Value val;
-			val.m_value = new std::vector<Value>(std::move(values));
+			val.setArray(create<Array>(resource));
+			auto& arr = *val.m_cell.array;
+			arr.reserve(values.size());
+			for (const Value& value : values) {
+				arr.emplace_back(value, resource);
+			}
 			return val;
 		}
 
-		static Value object(std::initializer_list<std::pair<std::string, Value>> values = {}) {
+		static Value object(std::initializer_list<std::pair<std::string, Value>> values = {}, std::pmr::memory_resource* resource = nullptr) {
 			Value val;
-			val.m_value = new Object();
-			auto& map = *std::get<Object*>(val.m_value);
+			val.setObject(create<Object>(resource));
+			auto& map = *val.m_cell.object;
 			for (auto& pair : values) {
-				map.emplace(pair);
+				map.try_emplace(std::string_view(pair.first), pair.second, resource);
 			}
 			return val;
 		}
 
+		// Empty containers allocating from resource, which has to outlive the Value (nullptr for the heap)
+		static Value array(std::pmr::memory_resource* resource) {
+			Value val;
+			val.setArray(create<Array>(resource));
+			return val;
+		}
+
+		static Value object(std::pmr::memory_resource* resource) {
+			Value val;
+			val.setObject(create<Object>(resource));
+			return val;
+		}
+
+		// Packed arrays stay packed while new elements have their type and are unpacked otherwise
 		void pushBack(const Value& value) {
 			JSON_VERIFY(getType() == Type::Array, "Type mismatch");
-			auto& arr = *std::get<std::vector<Value>*>(m_value);
+			detach(false);
+			if (isPacked()) {
+				append(Value(value));
+				return;
+			}
+			auto& arr = *m_cell.array;
 			arr.push_back(value);
 		}
 
         template<typename... Args>
 		void emplaceBack(Args&&... args) {
 			JSON_VERIFY(getType() == Type::Array, "Type mismatch");
-			auto& arr = *std::get<std::vector<Value>*>(m_value);
+			detach(false);
+			if (isPacked()) {
+				append(Value(std::forward<Args>(args)...));
+				return;
+			}
+			auto& arr = *m_cell.array;
 			arr.emplace_back(std::forward<Args>(args)...);
 		}
 
-		Value& operator[](const std::string& key) {
+		// Like pushBack, but an empty array becomes packed: its integers or doubles are stored contiguously
+		// (see asIntegerSpan and asNumberSpan), the parsers build numeric arrays this way in packed mode
+		// (see ValueBuilder::setPacked)
+		template<typename T>
+		void pushBackPacked(T value) requires std::same_as<T, int64_t> || std::same_as<T, double> {
+			JSON_VERIFY(getType() == Type::Array, "Type mismatch");
+			detach(false);
+			appendNumber(value);
+		}
+
+		// Like pushBack for an object, but an empty array becomes columnar: the keys of its first object are
+		// stored once and the values of every key in a column of their own, for as long as each following
+		// object has the same keys in the same order
+		// row is left an empty object when its members were moved into the columns, so it can be refilled
+		void pushBackColumnar(Value& row) {
+			JSON_VERIFY(getType() == Type::Array && row.getType() == Type::Object, "Type mismatch");
+			detach(false);
+			row.detach(false);
+			if (tag() == arrayTag && m_cell.array->empty()) {
+				Table* table = create<Table>(resourceOf(*m_cell.array));
+				destroy(m_cell.array);
+				setArray(table);
+			}
+			if (tag() == tableTag) appendRow(row);
+			else append(std::move(row));
+		}
+
+		// The mutable asArray() and operator[] unpack a packed or columnar array in place, the const ones read a
+		// copy of its elements built on first use (see arrayOfValues); element, the spans and column read it as is
+		bool isIntegerArray() const { return tag() == integerArrayTag; }
+		bool isNumberArray() const { return tag() == numberArrayTag; }
+		bool isColumnar() const { return tag() == tableTag; }
+
+		// Keys of every row of a columnar array, in member order
+		std::span<const String> columnKeys() const {
+			JSON_VERIFY(isColumnar(), "Type mismatch");
+			return { m_cell.table->keys.data(), m_cell.table->keys.size() };
+		}
+
+		// The values of key in every row of a columnar array, an array that may be packed
+		const Value& column(std::string_view key) const {
+			JSON_VERIFY(isColumnar(), "Type mismatch");
+			const Table& table = *m_cell.table;
+			for (size_t i = 0; i < table.keys.size(); ++i) {
+				if (table.keys[i] == key) return table.columns[i];
+			}
+			throw std::runtime_error("Column not found: " + std::string(key));
+		}
+
+		// Elements of an array or members of an object, without unpacking
+		size_t size() const {
+			if (getType() == Type::Object) return m_cell.object->size();
+			JSON_VERIFY(getType() == Type::Array, "Type mismatch");
+			if (tag() == integerArrayTag) return m_cell.integers->size();
+			if (tag() == numberArrayTag) return m_cell.numbers->size();
+			if (tag() == tableTag) return m_cell.table->rows;
+			return m_cell.array->size();
+		}
+
+		// Mutable references give the Value its own container (see detach), the const overloads never copy or
+		// change it
+		std::span<int64_t> asIntegerSpan() {
+			JSON_VERIFY(isIntegerArray(), "Type mismatch");
+			detach(true);
+			return { m_cell.integers->data(), m_cell.integers->size() };
+		}
+		std::span<double> asNumberSpan() {
+			JSON_VERIFY(isNumberArray(), "Type mismatch");
+			detach(true);
+			return { m_cell.numbers->data(), m_cell.numbers->size() };
+		}
+		std::span<const int64_t> asIntegerSpan() const {
+			JSON_VERIFY(isIntegerArray(), "Type mismatch");
+			return { m_cell.integers->data(), m_cell.integers->size() };
+		}
+		std::span<const double> asNumberSpan() const {
+			JSON_VERIFY(isNumberArray(), "Type mismatch");
+			return { m_cell.numbers->data(), m_cell.numbers->size() };
+		}
+
+		Value& operator[](std::string_view key) {
 			JSON_VERIFY(getType() == Type::Object, "Type mismatch");
-			auto& map = *std::get<Object*>(m_value);
-			return map[key];
+			return (*detach(true).m_cell.object)[key];
+		}
+		// Faster than a string_view for objects of the same Shape, see Key
+		Value& operator[](const Key& key) {
+			JSON_VERIFY(getType() == Type::Object, "Type mismatch");
+			return (*detach(true).m_cell.object)[key];
 		}
 		Value& operator[](size_t index) {
 			JSON_VERIFY(getType() == Type::Array, "Type mismatch");
-			auto& arr = *std::get<std::vector<Value>*>(m_value);
+			auto& arr = *unpack().detach(true).m_cell.array;
 			return arr[index];
 		}
 
 		bool& asBool() {
 			JSON_VERIFY(getType() == Type::Bool, "Type mismatch");
-			return std::get<bool>(m_value);
+			return m_cell.boolean;
 		}
 		double& asNumber() {
 			JSON_VERIFY(getType() == Type::Number, "Type mismatch");
-			return std::get<double>(m_value);
+			return m_cell.number;
 		}
 		int64_t& asInteger() {
 			JSON_VERIFY(getType() == Type::Integer, "Type mismatch");
-			return std::get<int64_t>(m_value);
+			return m_cell.integer;
 		}
+		// Moves the characters into a std::string the Value owns from then on, copies of the Value get a String
+		// again. Use asStringView to read without the move
+		// The std::string is always on the heap, also in a Value allocated from a memory_resource, and destroying
+		// or reassigning the Value frees it: call it only on Values that are destroyed, not on ones left in a
+		// monotonic arena (a Document's values are const and cannot get one)
 		std::string& asString() {
 			JSON_VERIFY(getType() == Type::String, "Type mismatch");
-			return *std::get<std::string*>(m_value);
+			if (tag() != boxedStringTag) {
+				std::string* text = new std::string(m_string.view());
+				m_string.~String();
+				new (&m_cell) Cell();
+				m_cell.text = text;
+				m_cell.tag = boxedStringTag;
+			}
+			return *m_cell.text;
 		}
-		std::vector<Value>& asArray() {
+		Array& asArray() {
             JSON_VERIFY(getType() == Type::Array, "Type mismatch");
-			return *std::get<std::vector<Value>*>(m_value);
+			return *unpack().detach(true).m_cell.array;
 		}
 		Object& asObject() {
             JSON_VERIFY(getType() == Type::Object, "Type mismatch");
-			return *std::get<Object*>(m_value);
+			return *detach(true).m_cell.object;
 		}
 
-		const Value& operator[](const std::string& key) const {
-			return const_cast<const Value&>(const_cast<Value*>(this)->operator[](key));
+		// A missing key reads as null, unlike the mutable overload it is not added
+		const Value& operator[](std::string_view key) const {
+			JSON_VERIFY(getType() == Type::Object, "Type mismatch");
+			static const Value missing;
+			auto it = m_cell.object->find(key);
+			return it != m_cell.object->end() ? it->second : missing;
+		}
+		// Unlike the string_view overload, a missing key throws
+		const Value& operator[](const Key& key) const {
+			JSON_VERIFY(getType() == Type::Object, "Type mismatch");
+			return m_cell.object->at(key);
 		}
 		const Value& operator[](size_t index) const {
-			return const_cast<const Value&>(const_cast<Value*>(this)->operator[](index));
+			return arrayOfValues()[index];
+		}
+		// Element index of any array by value, packed and columnar ones without unpacking: the row of a columnar
+		// array is a new object on the heap with copies of its keys and values
+		Value element(size_t index) const {
+			JSON_VERIFY(getType() == Type::Array, "Type mismatch");
+			if (tag() == integerArrayTag) return Value((*m_cell.integers)[index]);
+			if (tag() == numberArrayTag) return Value((*m_cell.numbers)[index]);
+			if (tag() == tableTag) {
+				const Table& table = *m_cell.table;
+				Value row = object();
+				Object& members = *row.m_cell.object;
+				members.reserve(table.keys.size());
+				for (size_t i = 0; i < table.keys.size(); ++i) members.try_emplace(String(table.keys[i]), table.columns[i].element(index));
+				return row;
+			}
+			return (*m_cell.array)[index];
 		}
 		const bool& asBool() const {
 			return const_cast<const bool&>(const_cast<Value*>(this)->asBool());
@@ -292,14 +852,20 @@ namespace Json
 		const int64_t& asInteger() const {
 			return const_cast<const int64_t&>(const_cast<Value*>(this)->asInteger());
 		}
-		const std::string& asString() const {
-			return const_cast<const std::string&>(const_cast<Value*>(this)->asString());
+		// A copy of the characters, asStringView reads them in place
+		std::string asString() const {
+			return std::string(asStringView());
+		}
+		std::string_view asStringView() const {
+			JSON_VERIFY(getType() == Type::String, "Type mismatch");
+			return tag() == boxedStringTag ? std::string_view(*m_cell.text) : m_string.view();
 		}
-		const std::vector<Value>& asArray() const {
-			return const_cast<const std::vector<Value>&>(const_cast<Value*>(this)->asArray());
+		const Array& asArray() const {
+			return arrayOfValues();
 		}
 		const Object& asObject() const {
-			return const_cast<const Object&>(const_cast<Value*>(this)->asObject());
+			JSON_VERIFY(getType() == Type::Object, "Type mismatch");
+			return *m_cell.object;
 		}
 
 		bool isNull() const { return getType() == Type::Null; }
@@ -310,102 +876,54 @@ namespace Json
 		bool isArray() const { return getType() == Type::Array; }
 		bool isObject() const { return getType() == Type::Object; }
 
-        std::string stringify(size_t indent = 0) const {
-			switch (getType()) {
-			case Type::Array: {
-				const auto& arr = this->asArray();
-				if (arr.empty()) return std::string(indent, ' ') + "[]";
-				std::string result = std::string(indent, ' ') + "[\n" +
-					arr[0].stringify(indent + 2);
-				
-				for (size_t i = 1; i < arr.size(); ++i) {
-					result += ",\n" + arr[i].stringify(indent + 2);
-				}
-				result += "\n" + std::string(indent, ' ') + "]";
-				return result;
-			}
-			case Type::Object: {
-				const auto& map = this->asObject();
-				std::string result = std::string(indent, ' ') + "{\n";				
-				for (const auto& [key, val] : map) {
-					if (val.getType() == Type::Array || val.getType() == Type::Object)
-						result += std::string(indent + 2, ' ') + "\"" + key + "\":\n"
-						+ val.stringify(indent + 2) + ",\n";
-					else result += std::string(indent + 2, ' ') + "\"" + key + "\": "
-						+ val.stringify() + ",\n";
-				}
-				if (!map.empty())
-				{
-					result.pop_back();
-					result.pop_back();
-					result += "\n";
-				}
-				result += std::string(indent, ' ') + "}";
-				return result;
-			}				
-			case Type::String:
-				return std::string(indent, ' ') + "\"" + *std::get<std::string*>(m_value) + "\"";
-			case Type::Bool:
-				return std::string(indent, ' ') + (std::get<bool>(m_value) ? "true" : "false");
-			case Type::Integer:
-				return std::string(indent, ' ') + std::to_string(std::get<int64_t>(m_value));
-			case Type::Number:
-				return std::string(indent, ' ') + std::to_string(std::get<double>(m_value));
-			case Type::Null:
-				return std::string(indent, ' ') + "null";
-			default:
-				throw std::runtime_error("Unknown type");
-			}
+		// Indented by two spaces per level, the whole value by indent more
+		std::string stringify(size_t indent = 0) const {
+			std::string result(indent, ' ');
+			Serializer<Value>(result, 2, indent).write(*this);
+			return result;
 		}
 
+		// Compact, after indent spaces
 		std::string stringifyLean(size_t indent = 0) const {
-			switch (getType()) {
-			case Type::Array: {
-				const auto& arr = this->asArray();
-				if (arr.empty()) return std::string(indent, ' ') + "[]";
-				std::string result = std::string(indent, ' ') + "[" +
-					arr[0].stringify(indent + 2);
-
-				for (size_t i = 1; i < arr.size(); ++i) {
-					result += "," + arr[i].stringify(indent + 2);
-				}
-				result += std::string(indent, ' ') + "]";
-				return result;
-			}
-			case Type::Object: {
-				const auto& map = this->asObject();
-				std::string result = std::string(indent, ' ') + "{";
-				for (const auto& [key, val] : map) {
-					if (val.getType() == Type::Array || val.getType() == Type::Object)
-						result += std::string(indent + 2, ' ') + "\"" + key + "\":"
-						+ val.stringify(indent + 2) + ",";
-					else result += std::string(indent + 2, ' ') + "\"" + key + "\": "
-						+ val.stringify() + ",";
-				}
-				if (!map.empty())
-					result.pop_back();
-				result += std::string(indent, ' ') + "}";
-				return result;
-			}
-			case Type::String:
-				return std::string(indent, ' ') + "\"" + *std::get<std::string*>(m_value) + "\"";
-			case Type::Bool:
-				return std::string(indent, ' ') + (std::get<bool>(m_value) ? "true" : "false");
-			case Type::Integer:
-				return std::string(indent, ' ') + std::to_string(std::get<int64_t>(m_value));
-			case Type::Number:
-				return std::string(indent, ' ') + std::to_string(std::get<double>(m_value));
-			case Type::Null:
-				return std::string(indent, ' ') + "null";
-			default:
-				throw std::runtime_error("Unknown type");
-			}
+			std::string result(indent, ' ');
+			Serializer<Value>(result).write(*this);
+			return result;
+		}
+
+		// Appends to output, which can be reused to serialize without allocating, see Serializer
+		// Unlike stringify's indent, indentWidth is the number of spaces per level, compact for 0
+		void stringifyTo(std::string& output, size_t indentWidth = 0) const {
+			Serializer<Value>(output, indentWidth).write(*this);
+		}
+
+		// Streams to sink in chunks of up to bufferSize bytes, see ChunkedOutput, indentWidth as above
+		template<Sink S>
+		void stringifyTo(S& sink, size_t indentWidth = 0, size_t bufferSize = ChunkedOutput<S>::defaultCapacity) const {
+			ChunkedOutput<S> output(sink, bufferSize);
+			Serializer<Value, ChunkedOutput<S>>(output, indentWidth).write(*this);
+			output.flush();
 		}
 
 		static auto parse(std::string_view input) {
 			return ContainerParser<Value>::parse(input);
 		}
 
+		// Pool overloads intern keys and short strings in pool, to share them with everything else parsed with it,
+		// see InternPool
+		static std::vector<Value> parse(std::string_view input, InternPool& pool) {
+			ValueBuilder<Value, true> builder(pool);
+			ContainerParser<Value>::parse(input, builder);
+			return builder.release();
+		}
+
+		// Resource overloads allocate the containers, strings and shapes of the result from resource, which has to
+		// outlive it
+		static std::vector<Value> parse(std::string_view input, std::pmr::memory_resource* resource) {
+			ValueBuilder<Value, true> builder(resource);
+			ContainerParser<Value>::parse(input, builder);
+			return builder.release();
+		}
+
 		template<Container C>
 		static auto parse(C& input) {
 			return ContainerParser<Value>::parse(input);
@@ -421,12 +939,40 @@ namespace Json
 			return StreamParser<Value>::parse(file);
 		}
 
+		// Handler overloads report parse events instead of building Values, see the Handler concept
+		template<Handler H>
+		static void parse(std::string_view input, H& handler) {
+			ContainerParser<Value>::parse(input, handler);
+		}
+
+		template<Container C, Handler H>
+		static void parse(C& input, H& handler) {
+			ContainerParser<Value>::parse(input, handler);
+		}
+
+		template<Stream S, Handler H>
+		static void parse(S& input, H& handler) {
+			StreamParser<Value>::parse(input, handler);
+		}
+
 		// Strict parser follows the json spec exactly, no comment, trailing comma or multiple root parsing
 		// Use when perfomance matters more than utility
 		static auto parseStrict(std::string_view input) {
 			return StrictContainerParser<Value>::parse(input);
 		}
 
+		static Value parseStrict(std::string_view input, InternPool& pool) {
+			ValueBuilder<Value> builder(pool);
+			StrictContainerParser<Value>::parse(input, builder);
+			return builder.releaseRoot();
+		}
+
+		static Value parseStrict(std::string_view input, std::pmr::memory_resource* resource) {
+			ValueBuilder<Value> builder(resource);
+			StrictContainerParser<Value>::parse(input, builder);
+			return builder.releaseRoot();
+		}
+
 		// Strict parser follows the json spec exactly, no comment, trailing comma or multiple root parsing
 		// Use when perfomance matters more than utility
 		template<Container C>
@@ -448,16 +994,72 @@ namespace Json
 			return StrictStreamParser<Value>::parse(file);
 		}
 
+		template<Handler H>
+		static void parseStrict(std::string_view input, H& handler) {
+			StrictContainerParser<Value>::parse(input, handler);
+		}
+
+		template<Container C, Handler H>
+		static void parseStrict(C& input, H& handler) {
+			StrictContainerParser<Value>::parse(input, handler);
+		}
+
+		template<Stream S, Handler H>
+		static void parseStrict(S& input, H& handler) {
+			StrictStreamParser<Value>::parse(input, handler);
+		}
+
+		// Two-stage parser, indexes the structure with SIMD before building the tree
+		// Same input rules as the strict parser but validated, use for large in-memory documents
+		static auto parseIndexed(std::string_view input) {
+			return StructuralParser<Value>::parse(input);
+		}
+
+		static Value parseIndexed(std::string_view input, InternPool& pool) {
+			ValueBuilder<Value> builder(pool);
+			StructuralParser<Value>::parse(input, builder);
+			return builder.releaseRoot();
+		}
+
+		static Value parseIndexed(std::string_view input, std::pmr::memory_resource* resource) {
+			ValueBuilder<Value> builder(resource);
+			StructuralParser<Value>::parse(input, builder);
+			return builder.releaseRoot();
+		}
+
+		// Two-stage parser, indexes the structure with SIMD before building the tree
+		// Same input rules as the strict parser but validated, use for large in-memory documents
+		template<Container C>
+		static auto parseIndexed(C& input) {
+			return StructuralParser<Value>::parse(input);
+		}
+
+		template<Handler H>
+		static void parseIndexed(std::string_view input, H& handler) {
+			StructuralParser<Value>::parse(input, handler);
+		}
+
+		template<Container C, Handler H>
+		static void parseIndexed(C& input, H& handler) {
+			StructuralParser<Value>::parse(input, handler);
+		}
+
 		bool operator==(const Value& other) const {
 			switch (getType()) {
 			case Type::Array:
-				return asArray() == other.asArray();
+				return compareArrays(other, [](const auto& lhs, const auto& rhs) { return lhs == rhs; });
 			case Type::Object:
 				return asObject() == other.asObject();
 			case Type::String:
-				return asString() == other.asString();
+				return asStringView() == other.asStringView();
+			case Type::Bool:
+				return other.isBool() && m_cell.boolean == other.m_cell.boolean;
+			case Type::Integer:
+				return other.isInteger() && m_cell.integer == other.m_cell.integer;
+			case Type::Number:
+				return other.isNumber() && m_cell.number == other.m_cell.number;
 			default:
-				return m_value == other.m_value;
+				return other.isNull();
 			}
 		}
 
@@ -480,11 +1082,11 @@ namespace Json
 			JSON_VERIFY(getType() == other.getType(), "Comparing Values containing different types");
 			switch (getType()) {
 			case Type::Array:
-				return asArray() < other.asArray();
+				return compareArrays(other, [](const auto& lhs, const auto& rhs) { return lhs < rhs; });
 			case Type::Object:
 				JSON_VERIFY(false, "Object does not have operator < defined");
 			case Type::String:
-				return asString() < other.asString();
+				return asStringView() < other.asStringView();
 			case Type::Bool:
 				return asBool() < other.asBool();
 			case Type::Integer:
@@ -502,11 +1104,11 @@ namespace Json
 			JSON_VERIFY(getType() == other.getType(), "Comparing Values containing different types");
 			switch (getType()) {
 			case Type::Array:
-				return asArray() > other.asArray();
+				return compareArrays(other, [](const auto& lhs, const auto& rhs) { return lhs > rhs; });
 			case Type::Object:
 				JSON_VERIFY(false, "Object does not have operator > defined");
 			case Type::String:
-				return asString() > other.asString();
+				return asStringView() > other.asStringView();
 			case Type::Bool:
 				return asBool() > other.asBool();
 			case Type::Integer:
@@ -524,11 +1126,11 @@ namespace Json
 			JSON_VERIFY(getType() == other.getType(), "Comparing Values containing different types");
 			switch (getType()) {
 			case Type::Array:
-				return asArray() <= other.asArray();
+				return compareArrays(other, [](const auto& lhs, const auto& rhs) { return lhs <= rhs; });
 			case Type::Object:
 				JSON_VERIFY(false, "Object does not have operator <= defined");
 			case Type::String:
-				return asString() <= other.asString();
+				return asStringView() <= other.asStringView();
 			case Type::Bool:
 				return asBool() <= other.asBool();
 			case Type::Integer:
@@ -546,11 +1148,11 @@ namespace Json
 			JSON_VERIFY(getType() == other.getType(), "Comparing Values containing different types");
 			switch (getType()) {
 			case Type::Array:
-				return asArray() >= other.asArray();
+				return compareArrays(other, [](const auto& lhs, const auto& rhs) { return lhs >= rhs; });
 			case Type::Object:
 				JSON_VERIFY(false, "Object does not have operator >= defined");
 			case Type::String:
-				return asString() >= other.asString();
+				return asStringView() >= other.asStringView();
 			case Type::Bool:
 				return asBool() >= other.asBool();
 			case Type::Integer:
@@ -569,7 +1171,7 @@ namespace Json
     {
         template<>
         struct EnumToTypeTrait<Value::Type::Array> {
-            using Type = std::vector<Value>*;
+            using Type = const Value::Array*;
         };
 
         template<>
@@ -589,12 +1191,12 @@ namespace Json
 
         template<>
         struct EnumToTypeTrait<Value::Type::Object> {
-            using Type = Value::Object*;
+            using Type = const Value::Object*;
         };
 
         template<>
         struct EnumToTypeTrait<Value::Type::String> {
-            using Type = std::string*;
+            using Type = std::string_view;
         };
 
         template<>
@@ -602,5 +1204,4 @@ namespace Json
             using Type = std::nullptr_t;
         };
     }
-}
-
+}
\ No newline at end of file
@@ -0,0 +1,241 @@
+#pragma once
+#include <stdint.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <cstring>
+#include <memory_resource>
+#include <deque>
+
+#include "JsonParser/InternPool.h"
+#include "JsonParser/Object.h"
+#include "JsonParser/String.h"
+
+namespace Json
+{
+	// Handler that builds Value trees from parse events, one Value per root
+	// With rejectDuplicateKeys a repeated key in the same object is an error, otherwise the last one wins
+	// Given the source buffer, strings and keys that are views into it are borrowed instead of copied,
+	// the caller has to keep the source alive as long as the Values (see Document)
+	// Given an arena, every container and decoded string is allocated from it and must not outlive it
+	// Given an InternPool, keys and short strings are interned in it and objects get their Shapes from it
+	// In packed mode arrays of only integers or only doubles are stored contiguously (see Value::pushBackPacked)
+	// In columnar mode arrays of objects with the same keys are stored column by column (see Value::pushBackColumnar)
+	//
+	// Objects with the same keys in the same order share one Shape: the values of an open object are kept aside
+	// while its keys are followed down a tree of the shapes seen so far, and moved into the object when it ends
+	// Objects with more than Shape::maxKeys keys, or whose keys branch off a shape that already has maxTransitions
+	// others, are built with keys of their own instead
+	template<typename Value, bool rejectDuplicateKeys = false>
+	class ValueBuilder
+	{
+	private:
+		static constexpr size_t maxTransitions = 32;
+		static constexpr uint32_t ownKeys = UINT32_MAX;
+
+		// Node 0 is the root, nullptr for no keys
+		struct ShapeNode {
+			const Shape* shape;
+			std::vector<uint32_t> next;
+		};
+
+		// One per level of nesting of open objects, reused
+		struct OpenObject {
+			std::vector<Value> values;
+			// ownKeys once the object stores its members itself
+			uint32_t node = 0;
+			// Where the value of the last key goes, before the end of values for a repeated key
+			uint32_t slot = 0;
+		};
+
+		std::vector<Value> m_roots;
+		std::vector<Value*> m_stack;
+		std::string_view m_source;
+		// Containers, strings and shapes allocate from m_resource, which is m_arena for a Document: strings are
+		// then borrowed from the arena instead, which never frees them
+		std::pmr::memory_resource* m_resource = nullptr;
+		std::pmr::monotonic_buffer_resource* m_arena = nullptr;
+		InternPool* m_pool = nullptr;
+		String m_key;
+		bool m_packed = false;
+		bool m_columnar = false;
+		// Objects inside arrays in columnar mode, one reused per level of nesting, never moved by the deque
+		std::deque<Value> m_rows;
+		size_t m_openRows = 0;
+		std::vector<ShapeNode> m_shapes = { ShapeNode{ nullptr, {} } };
+		std::vector<OpenObject> m_objects;
+		size_t m_openObjects = 0;
+
+		inline Value newObject() const { return Value::object(m_resource); }
+
+		// The child of node for key, ownKeys when node has too many children already
+		uint32_t transition(uint32_t node, const String& key) {
+			for (uint32_t child : m_shapes[node].next) {
+				if (m_shapes[child].shape->keys().back() == key) return child;
+			}
+			if (m_shapes[node].next.size() == maxTransitions) return ownKeys;
+			const Shape* shape;
+			if (m_pool) {
+				shape = m_pool->shape(m_shapes[node].shape, key);
+				if (!shape) return ownKeys;
+				Shape::retain(shape);
+			}
+			else shape = Shape::extend(m_shapes[node].shape, key, m_resource);
+			const uint32_t child = static_cast<uint32_t>(m_shapes.size());
+			m_shapes.push_back({ shape, {} });
+			m_shapes[node].next.push_back(child);
+			return child;
+		}
+
+		// Moves the values kept aside into the object, which adds its members itself from then on
+		void giveOwnKeys(Value& object, OpenObject& open) {
+			auto& members = object.buildingObject();
+			const Shape* shape = m_shapes[open.node].shape;
+			members.reserve(open.values.size() + 1);
+			for (size_t i = 0; i < open.values.size(); ++i) members.try_emplace(shape->keys()[i].borrowOrCopy(), std::move(open.values[i]));
+			open.values.clear();
+			open.node = ownKeys;
+		}
+
+		inline String makeString(std::string_view value) const {
+			// std::less orders pointers into unrelated buffers too
+			std::less<const char*> less;
+			if (!less(value.data(), m_source.data()) && !less(m_source.data() + m_source.size(), value.data() + value.size()))
+				return String::borrow(value);
+			if (m_arena && value.size() > String::inlineCapacity) {
+				char* data = static_cast<char*>(m_arena->allocate(value.size(), 1));
+				std::memcpy(data, value.data(), value.size());
+				return String::borrow(std::string_view(data, value.size()));
+			}
+			return m_pool ? m_pool->intern(value) : String(value, m_resource);
+		}
+
+		// escapeFree when the parser found nothing to escape in value, see String::isEscapeFree
+		inline String makeString(std::string_view value, bool escapeFree) const {
+			String string = makeString(value);
+			if (escapeFree) string.markEscapeFree();
+			return string;
+		}
+
+		// In packed mode numbers in arrays keep the array packed for as long as they all have the same type
+		template<typename T>
+		inline void addNumber(T value) {
+			if (m_packed && !m_stack.empty() && m_stack.back()->isArray()) m_stack.back()->pushBackPacked(value);
+			else add(value);
+		}
+
+		// Elements never move while one of their children is open, so the stack pointers stay valid
+		template<typename T>
+		inline Value& add(T&& value) {
+			if (m_stack.empty()) return m_roots.emplace_back(std::forward<T>(value));
+
+			Value& parent = *m_stack.back();
+			if (parent.isArray()) {
+				auto& array = parent.buildingArray();
+				array.emplace_back(std::forward<T>(value));
+				return array.back();
+			}
+
+			OpenObject& open = m_objects[m_openObjects - 1];
+			if (open.node != ownKeys) {
+				if (open.slot == open.values.size()) return open.values.emplace_back(std::forward<T>(value));
+				Value& member = open.values[open.slot];
+				member = Value(std::forward<T>(value));
+				return member;
+			}
+
+			auto& object = parent.buildingObject();
+			auto [it, inserted] = object.try_emplace(std::move(m_key));
+			if constexpr (rejectDuplicateKeys) {
+				if (!inserted) throw std::runtime_error("Duplicate key: " + m_key.str());
+			}
+			it->second = Value(std::forward<T>(value));
+			return it->second;
+		}
+
+	public:
+		ValueBuilder() = default;
+		explicit ValueBuilder(std::string_view source, std::pmr::monotonic_buffer_resource* arena = nullptr)
+			: m_source(source), m_resource(arena), m_arena(arena) {}
+		explicit ValueBuilder(InternPool& pool) : m_pool(&pool) {}
+		explicit ValueBuilder(std::pmr::memory_resource* resource) : m_resource(resource) {}
+
+		~ValueBuilder() {
+			for (const ShapeNode& node : m_shapes) Shape::release(node.shape);
+		}
+
+		ValueBuilder(const ValueBuilder&) = delete;
+		ValueBuilder& operator=(const ValueBuilder&) = delete;
+
+		inline void onNull() { add(nullptr); }
+		inline void onBool(bool value) { add(value); }
+		inline void onInt64(int64_t value) { addNumber(value); }
+		inline void onDouble(double value) { addNumber(value); }
+		inline void onString(std::string_view value) { onString(value, false); }
+		inline void onString(std::string_view value, bool escapeFree) { add(makeString(value, escapeFree)); }
+		inline void onKey(std::string_view key) { onKey(key, false); }
+		inline void onKey(std::string_view key, bool escapeFree) {
+			m_key = makeString(key, escapeFree);
+			OpenObject& open = m_objects[m_openObjects - 1];
+			if (open.node == ownKeys) return;
+
+			const Shape* shape = m_shapes[open.node].shape;
+			const size_t size = shape ? shape->size() : 0;
+			const size_t found = shape ? shape->find(m_key) : 0;
+			if (found != size) {
+				if constexpr (rejectDuplicateKeys) throw std::runtime_error("Duplicate key: " + m_key.str());
+				open.slot = static_cast<uint32_t>(found);
+				return;
+			}
+			const uint32_t next = size == Shape::maxKeys ? ownKeys : transition(open.node, m_key);
+			if (next == ownKeys) {
+				giveOwnKeys(*m_stack.back(), open);
+				return;
+			}
+			open.node = next;
+			open.slot = static_cast<uint32_t>(size);
+		}
+
+		inline void onStartArray() { m_stack.push_back(&add(Value::array(m_resource))); }
+		inline void onEndArray() { m_stack.pop_back(); }
+		inline void onStartObject() {
+			if (m_columnar && !m_stack.empty() && m_stack.back()->isArray()) {
+				if (m_openRows == m_rows.size()) m_rows.emplace_back();
+				Value& row = m_rows[m_openRows++];
+				if (!row.isObject()) row = newObject();
+				m_stack.push_back(&row);
+			}
+			else m_stack.push_back(&add(newObject()));
+
+			if (m_openObjects == m_objects.size()) m_objects.emplace_back();
+			m_objects[m_openObjects++].node = 0;
+		}
+
+		inline void onEndObject() {
+			Value* object = m_stack.back();
+			m_stack.pop_back();
+			OpenObject& open = m_objects[--m_openObjects];
+			if (open.node != ownKeys && !open.values.empty()) {
+				object->buildingObject().assign(m_shapes[open.node].shape, open.values.data());
+				open.values.clear();
+			}
+			if (m_openRows && object == &m_rows[m_openRows - 1]) {
+				--m_openRows;
+				m_stack.back()->pushBackColumnar(*object);
+			}
+		}
+
+		void setPacked(bool packed) { m_packed = packed; }
+		void setColumnar(bool columnar) { m_columnar = columnar; }
+
+		std::vector<Value>& roots() { return m_roots; }
+
+		std::vector<Value> release() { return std::move(m_roots); }
+
+		// The first root, or null when nothing was parsed
+		Value releaseRoot() { return m_roots.empty() ? Value() : std::move(m_roots.front()); }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#pragma once
+#include <stdint.h>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "JsonParser/Concepts.h"
+#include "JsonParser/Serializer.h"
+#include "JsonParser/Utils/Macros.h"
+#include "JsonParser/Utils/NumberFormatting.h"
+
+namespace Json
+{
+	// Emits JSON straight into an output buffer without building a Value, one call per token:
+	//   writer.startObject().key("id").value(42).key("tags").startArray().value("a").endArray().endObject();
+	// Commas, the ':' after keys and the layout are taken care of, strings are escaped, numbers written like
+	// Serializer writes them. Nothing is allocated but the output growing, so with a reused std::string or a
+	// ChunkedOutput (see Sink.h) writing a response takes no allocation at all
+	// Compact unless indent is set, which lays the output out like Serializer
+	//
+	// Unless NODEBUG is defined, which also turns off JSON_VERIFY, every call is checked against the nesting so far
+	// (a key only directly inside an object, a value after each key, brackets matching, a single root) and a
+	// misplaced one throws. The checks keep a bit per open container in the Writer and allocate nothing, so they
+	// limit the nesting to maxDepth
+	template<OutputBuffer Output = std::string>
+	class Writer
+	{
+	public:
+		static constexpr size_t maxDepth = 1024;
+
+	private:
+		Output& m_output;
+		size_t m_indent;
+		// Open objects and arrays
+		size_t m_level = 0;
+		// Whether the next element or member needs a comma before it
+		bool m_separate = false;
+		bool m_afterKey = false;
+#ifndef NODEBUG
+		// Bit level % 64 of word level / 64 is set when the container opened at that level is an object
+		uint64_t m_objects[maxDepth / 64] = {};
+		bool m_rootWritten = false;
+
+		inline bool inObject() const noexcept {
+			return m_level && (m_objects[(m_level - 1) / 64] >> ((m_level - 1) % 64) & 1);
+		}
+#endif
+
+		inline void newLine() {
+			if (!m_indent) return;
+			m_output.push_back('\n');
+			m_output.append(m_level * m_indent, ' ');
+		}
+
+		// Separates the value about to be written from the previous one
+		inline void beforeValue() {
+#ifndef NODEBUG
+			if (!m_level) JSON_VERIFY(!m_rootWritten, "Writer: more than one root value");
+			else JSON_VERIFY(!inObject() || m_afterKey, "Writer: value in an object without a key");
+			if (!m_level) m_rootWritten = true;
+#endif
+			if (m_afterKey) {
+				m_afterKey = false;
+				return;
+			}
+			if (!m_level) return;
+			if (m_separate) m_output.push_back(',');
+			newLine();
+		}
+
+		inline void open(char bracket) {
+			beforeValue();
+#ifndef NODEBUG
+			JSON_VERIFY(m_level < maxDepth, "Writer: nested deeper than maxDepth");
+			const uint64_t bit = uint64_t(1) << (m_level % 64);
+			if (bracket == '{') m_objects[m_level / 64] |= bit;
+			else m_objects[m_level / 64] &= ~bit;
+#endif
+			m_output.push_back(bracket);
+			++m_level;
+			m_separate = false;
+		}
+
+		inline void close(char bracket) {
+#ifndef NODEBUG
+			JSON_VERIFY(m_level && inObject() == (bracket == '}'), "Writer: mismatched end of object or array");
+			JSON_VERIFY(!m_afterKey, "Writer: key without a value");
+#endif
+			--m_level;
+			// m_separate is only set when something was written since open
+			if (m_separate) newLine();
+			m_output.push_back(bracket);
+			m_separate = true;
+		}
+
+		inline void writeString(std::string_view value) {
+			m_output.push_back('"');
+			Detail::appendEscaped(m_output, value);
+			m_output.push_back('"');
+		}
+
+		inline Writer& written() {
+			m_separate = true;
+			return *this;
+		}
+
+	public:
+		explicit Writer(Output& output, size_t indent = 0) noexcept : m_output(output), m_indent(indent) {}
+
+		Writer& startObject() { open('{'); return *this; }
+		Writer& endObject() { close('}'); return *this; }
+		Writer& startArray() { open('['); return *this; }
+		Writer& endArray() { close(']'); return *this; }
+
+		Writer& key(std::string_view key) {
+#ifndef NODEBUG
+			JSON_VERIFY(inObject(), "Writer: key outside of an object");
+			JSON_VERIFY(!m_afterKey, "Writer: key without a value");
+#endif
+			if (m_separate) m_output.push_back(',');
+			newLine();
+			writeString(key);
+			m_output.push_back(':');
+			if (m_indent) m_output.push_back(' ');
+			m_afterKey = true;
+			return *this;
+		}
+
+		Writer& null() {
+			beforeValue();
+			m_output.append("null");
+			return written();
+		}
+
+		Writer& value(std::nullptr_t) { return null(); }
+
+		Writer& value(bool value) {
+			beforeValue();
+			m_output.append(value ? "true" : "false");
+			return written();
+		}
+
+		template<std::integral T> requires (!std::same_as<T, bool>)
+		Writer& value(T value) {
+			beforeValue();
+			char buffer[Detail::maxNumberChars];
+			char* end;
+			if constexpr (std::is_unsigned_v<T> && sizeof(T) >= sizeof(int64_t)) end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+			else end = Detail::formatInteger(static_cast<int64_t>(value), buffer);
+			m_output.append(std::string_view(buffer, end - buffer));
+			return written();
+		}
+
+		// Shortest round trip, NaN and infinities as null
+		template<std::floating_point T>
+		Writer& value(T value) {
+			beforeValue();
+			char buffer[Detail::maxNumberChars];
+			m_output.append(std::string_view(buffer, Detail::formatNumber(static_cast<double>(value), buffer) - buffer));
+			return written();
+		}
+
+		Writer& value(std::string_view value) {
+			beforeValue();
+			writeString(value);
+			return written();
+		}
+		Writer& value(const char* value) { return this->value(std::string_view(value)); }
+		Writer& value(const std::string& value) { return this->value(std::string_view(value)); }
+
+		// JSON text written as it is, the caller guarantees it is a single valid value
+		Writer& rawValue(std::string_view json) {
+			beforeValue();
+			m_output.append(json);
+			return written();
+		}
+
+		// True once a root value was written and every object and array ended
+		bool complete() const noexcept { return m_level == 0 && m_separate; }
+	};
+}
\ No newline at end of file
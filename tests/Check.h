@@ -0,0 +1,34 @@
+#pragma once
+#include <exception>
+#include <iostream>
+
+// Checks for the test executables: a failed one reports its line and the test returns a failure exit code
+
+namespace Test
+{
+	inline int failures = 0;
+
+	inline void fail(const char* file, int line, const char* expression) {
+		++failures;
+		std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+	}
+
+	template<typename F>
+	bool throws(F f) {
+		try {
+			f();
+		}
+		catch (const std::exception&) {
+			return true;
+		}
+		return false;
+	}
+
+	inline int result() {
+		if (failures) std::cerr << failures << " check(s) failed" << std::endl;
+		return failures ? 1 : 0;
+	}
+}
+
+#define CHECK(condition) do { if (!(condition)) Test::fail(__FILE__, __LINE__, #condition); } while (0)
+#define CHECK_THROWS(expression) do { if (!Test::throws([&] { (void)(expression); })) Test::fail(__FILE__, __LINE__, "throws " #expression); } while (0)
\ No newline at end of file
@@ -1,4 +1,7 @@
 #include "JsonParser/Value.h"
+#include "JsonParser/Document.h"
+#include "JsonParser/TapeDocument.h"
+#include "JsonParser/OnDemand.h"
 #include <iostream>
 #include <fstream>
 #include <chrono>
@@ -74,12 +77,100 @@ void benchmarkString(const std::string& json, const std::string& name, int itera
     std::cout << std::endl;
 }
 
+template<typename ParseFunction>
+void benchmarkParser(const std::string& content, const std::string& name, ParseFunction parse, int iterations) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (int i = 0; i < iterations; ++i) {
+        try {
+            volatile bool isObject = parse(content);
+            (void)isObject;
+        } catch (const std::exception& e) {
+            std::cout << "Parse error: " << e.what() << std::endl;
+            return;
+        }
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    double throughput = (content.size() * iterations) / (1024.0 * 1024.0) / (duration.count() / 1000000.0);
+
+    std::cout << name << ": " << static_cast<double>(duration.count()) / iterations << " μs per parse, "
+        << throughput << " MB/s" << std::endl;
+}
+
+void benchmarkParsers(const std::string& filename, int iterations = 10000) {
+    std::cout << "Comparing parsers on " << filename << " with " << iterations << " iterations..." << std::endl;
+
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cout << "Failed to open " << filename << std::endl;
+        return;
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    benchmarkParser(content, "parseStrict", [](const std::string& input) { return Json::Value::parseStrict(input).isObject(); }, iterations);
+    benchmarkParser(content, "parseIndexed", [](const std::string& input) { return Json::Value::parseIndexed(input).isObject(); }, iterations);
+    benchmarkParser(content, "Document (in place)", [](const std::string& input) { return Json::Document::parseStrict(input).root().isObject(); }, iterations);
+    benchmarkParser(content, "TapeDocument", [](const std::string& input) { return Json::TapeDocument::parse(input).root().isObject(); }, iterations);
+    benchmarkParser(content, "OnDemand (one field)", [](const std::string& input) { return Json::OnDemandDocument(input)["address"]["city"].isString(); }, iterations);
+    std::cout << std::endl;
+}
+
+// Walks a comment and whitespace heavy payload with each kernel set the CPU supports
+void benchmarkScanKernels(int iterations = 200) {
+    std::cout << "Comparing scan kernels with " << iterations << " iterations..." << std::endl;
+
+    std::string content;
+    while (content.size() < (1 << 20)) {
+        content += "    // request handled by worker, see trace for details\n";
+        content += "\t\t/* upstream latency sample, values in microseconds\n\t\t   collected by the sidecar */\n";
+        content += "        \"latency\":                                1234,\n\n";
+    }
+
+    const auto& available = Json::Detail::cpuFeatures();
+    struct Tier { const char* name; Json::Detail::CpuFeatures features; bool supported; };
+    const Tier tiers[] = {
+        { "Scalar", {}, true },
+        { "SSE2", { true, false, false }, available.sse2 },
+        { "AVX2", { true, true, false }, available.avx2 },
+        { "AVX-512BW", { true, true, true }, available.avx512bw },
+    };
+
+    const char* data = content.data();
+    const size_t size = content.size();
+    for (const Tier& tier : tiers) {
+        if (!tier.supported) continue;
+        const Json::Detail::ScanKernels kernels = Json::Detail::selectScanKernels(tier.features);
+
+        size_t tokens = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int n = 0; n < iterations; ++n) {
+            for (size_t i = kernels.skipWhitespace(data, size, 0); i < size; i = kernels.skipWhitespace(data, size, i)) {
+                if (data[i] == '"') i = kernels.findStringDelimiter(data, size, i + 1);
+                ++i;
+                ++tokens;
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        double throughput = (size * static_cast<double>(iterations)) / (1024.0 * 1024.0) / (duration.count() / 1000000.0);
+
+        volatile size_t sink = tokens;
+        (void)sink;
+        std::cout << tier.name << ": " << throughput << " MB/s" << std::endl;
+    }
+    std::cout << std::endl;
+}
+
 int main() {
     std::cout << "=== JSON Parser Benchmark ===" << std::endl;
     
     // Benchmark files
     benchmarkFile("tests/test.json", 5000);
     benchmarkFile("tests/test_edge_cases.json", 3000);
+    benchmarkParsers("tests/standard_compliant.json", 20000);
+    benchmarkScanKernels();
     
     // Benchmark simple strings
     benchmarkString("{\"key\": \"value\"}", "simple object", 50000);
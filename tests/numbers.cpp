@@ -0,0 +1,153 @@
+#include "JsonParser/Value.h"
+#include "JsonParser/Utils/NumberParsing.h"
+#include "JsonParser/Utils/NumberFormatting.h"
+#include "Check.h"
+#include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+// Integer parsing eight digits at a time, double parsing through Clinger and Eisel-Lemire, and the formatting
+// that has to read back to the same bits
+
+using Json::Detail::IntegerStatus;
+
+static IntegerStatus parseInteger(const std::string& text, int64_t& value) {
+	return Json::Detail::parseInteger(text.data(), text.data() + text.size(), value);
+}
+
+static double parseDouble(const std::string& text) {
+	return Json::Detail::parseDouble(text.data(), text.data() + text.size());
+}
+
+static bool sameBits(double lhs, double rhs) {
+	return std::memcmp(&lhs, &rhs, sizeof(double)) == 0;
+}
+
+// parseDouble has to round exactly like strtod
+static bool parsesLikeStrtod(const std::string& text) {
+	return sameBits(parseDouble(text), std::strtod(text.c_str(), nullptr));
+}
+
+static std::string format(double value) {
+	char buffer[Json::Detail::maxNumberChars];
+	return std::string(buffer, Json::Detail::formatNumber(value, buffer));
+}
+
+int main() {
+	// Integers around the 8-digit chunks and the int64_t limits
+	{
+		int64_t value = 0;
+		for (const std::string text : { "0", "7", "1234567", "12345678", "123456789", "9999999999999999", "1234567812345678",
+			"123456781234567812", "-12345678", "00000000", "0000000012345678", "9223372036854775807" }) {
+			CHECK(parseInteger(text, value) == IntegerStatus::Ok);
+			CHECK(value == std::strtoll(text.c_str(), nullptr, 10));
+		}
+		CHECK(parseInteger("-9223372036854775808", value) == IntegerStatus::Ok && value == std::numeric_limits<int64_t>::min());
+		CHECK(parseInteger("9223372036854775808", value) == IntegerStatus::Overflow);
+		CHECK(parseInteger("-9223372036854775809", value) == IntegerStatus::Overflow);
+		CHECK(parseInteger("18446744073709551616", value) == IntegerStatus::Overflow);
+		CHECK(parseInteger("123456789012345678901234567890", value) == IntegerStatus::Overflow);
+		for (const std::string text : { "", "-", "1234567a", "12345678a", "a2345678", "1234:678", "1234/678", "12.45678", "123456789012345678901x", "+1", "+-1", "-+1" })
+			CHECK(parseInteger(text, value) == IntegerStatus::Invalid);
+
+		std::mt19937_64 random(42);
+		for (int i = 0; i < 20000; ++i) {
+			const int64_t expected = static_cast<int64_t>(random() >> (random() % 64));
+			const int64_t signedExpected = i % 2 ? -expected : expected;
+			CHECK(parseInteger(std::to_string(signedExpected), value) == IntegerStatus::Ok && value == signedExpected);
+		}
+	}
+
+	// Doubles on both sides of the fast paths, the subnormal range and the rounding boundaries
+	{
+		for (const std::string text : { "0", "-0", "0.0", "1", "0.1", "0.2", "0.3", "1.5", "3.141592653589793", "1e22", "1e23",
+			"9007199254740992", "9007199254740993", "9007199254740995", "123456789012345678", "1234567890123456789",
+			"12345678901234567890", "0.000001", "1e-7", "2.2250738585072014e-308", "2.2250738585072011e-308",
+			"4.9406564584124654e-324", "2.4703282292062327e-324", "2.4703282292062328e-324", "1e-400",
+			"1.7976931348623157e308", "1.7976931348623158e308", "0.30000000000000004", "7.0e-10", "8.98846567431158e307",
+			"3.0540412816652027e-16", "1.00000000000000011102230246251565404236316680908203125",
+			"0.1000000000000000055511151231257827021181583404541015625", "123.456e-2", "5e-324", "6.02214076e23",
+			"-1.7976931348623157e308" }) {
+			CHECK(parsesLikeStrtod(text));
+		}
+		// More than 19 significant digits
+		CHECK(parsesLikeStrtod("17976931348623157" + std::string(292, '0')));
+		CHECK(parsesLikeStrtod("0." + std::string(30, '0') + "12345678901234567890123"));
+		CHECK(std::signbit(parseDouble("-0.0")));
+		// Underflow is a signed zero on both the Eisel-Lemire and the long-mantissa path, overflow throws on both
+		for (const std::string& zero : { std::string("1e-400"), std::string("1.00000000000000000000e-400"), "0." + std::string(400, '0') + "123456789012345678901" }) {
+			CHECK(sameBits(parseDouble(zero), 0.0));
+			CHECK(sameBits(parseDouble("-" + zero), -0.0));
+		}
+		CHECK_THROWS(parseDouble("1.00000000000000000000e400"));
+		CHECK_THROWS(parseDouble("-123456789012345678901" + std::string(300, '0')));
+		CHECK_THROWS(parseDouble("1e309"));
+		CHECK_THROWS(parseDouble("-2e308"));
+		CHECK_THROWS(parseDouble("1e"));
+		CHECK_THROWS(parseDouble("."));
+		CHECK_THROWS(parseDouble("+1.5"));
+		CHECK_THROWS(parseDouble("+1e5"));
+
+		// Random bit patterns written in the shortest form and with all 17 digits read back exactly
+		std::mt19937_64 random(7);
+		char buffer[64];
+		for (int i = 0; i < 50000; ++i) {
+			const uint64_t bits = random();
+			double expected;
+			std::memcpy(&expected, &bits, sizeof(expected));
+			if (!std::isfinite(expected)) continue;
+			const std::string shortest = format(expected);
+			CHECK(sameBits(parseDouble(shortest), expected));
+			const int length = std::snprintf(buffer, sizeof(buffer), "%.17g", expected);
+			CHECK(parsesLikeStrtod(std::string(buffer, length)));
+		}
+	}
+
+	// Formatting: shortest form, integral doubles stay doubles, JSON has no NaN or infinity
+	{
+		CHECK(format(0.1) == "0.1");
+		CHECK(format(1.0) == "1.0");
+		CHECK(format(-0.0) == "-0.0");
+		CHECK(format(1e23) == "1e+23");
+		CHECK(format(5e-324) == "5e-324");
+		CHECK(format(std::numeric_limits<double>::infinity()) == "null");
+		CHECK(format(std::nan("")) == "null");
+		char buffer[Json::Detail::maxIntegerChars];
+		CHECK(std::string(buffer, Json::Detail::formatInteger(std::numeric_limits<int64_t>::min(), buffer)) == "-9223372036854775808");
+		CHECK(std::string(buffer, Json::Detail::formatInteger(0, buffer)) == "0");
+		CHECK(std::string(buffer, Json::Detail::formatInteger(1000000007, buffer)) == "1000000007");
+	}
+
+	// The same values through the parsers and back out of the serializer
+	{
+		const std::string text = "[0,-1,9223372036854775807,-9223372036854775808,0.1,1e23,2.2250738585072014e-308,5e-324,1.7976931348623157e308]";
+		const Json::Value strict = Json::Value::parseStrict(text);
+		CHECK(Json::Value::parseIndexed(text) == strict);
+		CHECK(Json::Value::parse(text)[0] == strict);
+		CHECK(Json::Value::parseIndexed(strict.stringifyLean()) == strict);
+		CHECK(strict[2].asInteger() == std::numeric_limits<int64_t>::max());
+		CHECK(strict[6].asNumber() == std::numeric_limits<double>::min());
+		CHECK(strict[7].asNumber() == std::numeric_limits<double>::denorm_min());
+	}
+
+	// Neither direction depends on the locale's decimal point, which the snprintf and strtod fallback has to swap
+	{
+		const std::string longMantissa = "0.1234567890123456789012345";
+		const double expected = parseDouble(longMantissa);
+		for (const char* name : { "de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "fr_FR" }) {
+			if (!std::setlocale(LC_NUMERIC, name)) continue;
+			CHECK(format(0.5) == "0.5");
+			CHECK(format(-1234.25) == "-1234.25");
+			CHECK(sameBits(parseDouble(longMantissa), expected));
+			break;
+		}
+		std::setlocale(LC_NUMERIC, "C");
+	}
+
+	return Test::result();
+}
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "JsonParser/Value.h"
+#include "JsonParser/Document.h"
+#include "JsonParser/TapeDocument.h"
+#include "JsonParser/OnDemand.h"
+#include "Check.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// The indexed, tape and on-demand parsers against the strict parser, and the input each of them has to reject
+
+using Json::Value;
+
+static Value fromTape(const Json::TapeDocument::Ref& ref) {
+	switch (ref.getType()) {
+	case Json::TapeDocument::Type::Array: {
+		Value array = Value::array();
+		for (const auto& element : ref.asArray()) array.pushBack(fromTape(element));
+		return array;
+	}
+	case Json::TapeDocument::Type::Object: {
+		Value object = Value::object();
+		for (const auto& [key, member] : ref.asObject()) object[key] = fromTape(member);
+		return object;
+	}
+	case Json::TapeDocument::Type::String: return Value(ref.asString());
+	case Json::TapeDocument::Type::Bool: return Value(ref.asBool());
+	case Json::TapeDocument::Type::Integer: return Value(ref.asInteger());
+	case Json::TapeDocument::Type::Number: return Value(ref.asNumber());
+	default: return Value();
+	}
+}
+
+static Value fromOnDemand(const Json::OnDemandValue& value) {
+	switch (value.getType()) {
+	case Json::OnDemandValue::Type::Array: {
+		Value array = Value::array();
+		for (const auto& element : value.getArray()) array.pushBack(fromOnDemand(element));
+		return array;
+	}
+	case Json::OnDemandValue::Type::Object: {
+		Value object = Value::object();
+		for (const auto& [key, member] : value.getObject()) object[key] = fromOnDemand(member);
+		return object;
+	}
+	case Json::OnDemandValue::Type::String: {
+		std::string buffer;
+		return Value(value.getString(buffer));
+	}
+	case Json::OnDemandValue::Type::Bool: return Value(value.getBool());
+	case Json::OnDemandValue::Type::Integer: return Value(value.getInt64());
+	case Json::OnDemandValue::Type::Number: return Value(value.getDouble());
+	default: return Value();
+	}
+}
+
+static std::string readFile(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	std::stringstream content;
+	content << file.rdbuf();
+	return content.str();
+}
+
+// Every parser reads text to the same value, which survives being written and read again
+static void checkRoundTrip(const std::string& text) {
+	const Value expected = Value::parseStrict(text);
+	const Value indexed = Value::parseIndexed(text);
+	CHECK(indexed == expected);
+	CHECK(Value::parseIndexed(indexed.stringifyLean()) == expected);
+	CHECK(Value::parseIndexed(indexed.stringify()) == expected);
+
+	const Json::TapeDocument tape = Json::TapeDocument::parse(text);
+	CHECK(fromTape(tape.root()) == expected);
+
+	const Json::OnDemandDocument onDemand(text);
+	CHECK(fromOnDemand(onDemand.root()) == expected);
+
+	const Json::Document document = Json::Document::parseIndexed(text);
+	CHECK(document.root() == expected);
+}
+
+static bool indexedRejects(const std::string& text) {
+	return Test::throws([&] { Value::parseIndexed(text); });
+}
+
+static bool tapeRejects(const std::string& text) {
+	return Test::throws([&] { Json::TapeDocument::parse(text); });
+}
+
+static bool strictRejects(const std::string& text) {
+	std::istringstream stream(text);
+	return Test::throws([&] { Value::parseStrict(text); }) && Test::throws([&] { Value::parseStrict(stream); });
+}
+
+int main() {
+	const std::vector<std::string> documents = {
+		"0", "-0", "42", "-9223372036854775808", "9223372036854775807",
+		"3.25", "-0.5e-3", "1E+2", "6.022e23", "2.2250738585072014e-308", "true", "false", "null",
+		R"("")", R"("plain")", R"("esc\"aped\\ \/ \b\f\n\r\t")", R"("é世🌍")",
+		"[]", "{}", "[[]]", R"({"":{}})", "[1,2.5,\"x\",true,null,[],{}]",
+		" \t\r\n{ \"a\" : [ 1 , { \"b\" : null } ] , \"c\" : \"d\" } \n",
+		R"({"rows":[{"id":1,"name":"one"},{"id":2,"name":"two"},{"id":3,"name":"three"}]})",
+		// Strings and escapes across the 64-byte blocks of the structural index
+		"[\"" + std::string(61, 'a') + "\\\"" + std::string(70, 'b') + "\",\"" + std::string(200, 'c') + "\\\\\"]",
+		"[" + std::string(63, ' ') + "1," + std::string(64, ' ') + "\"" + std::string(127, 'q') + "\"]",
+	};
+	for (const std::string& text : documents) checkRoundTrip(text);
+
+	std::string nested;
+	for (int i = 0; i < 200; ++i) nested += "[{\"k\":";
+	nested += "1";
+	for (int i = 0; i < 200; ++i) nested += "}]";
+	checkRoundTrip(nested);
+
+	checkRoundTrip(readFile(JSONPARSER_TEST_DIR "/standard_compliant.json"));
+
+	// Integers past int64_t are read as the nearest double, the cursor only reads them with getDouble
+	CHECK(Value::parseIndexed(std::string_view("18446744073709551616")) == Value(18446744073709551616.0));
+	CHECK(Json::TapeDocument::parse(std::string_view("-18446744073709551616")).root().asNumber() == -18446744073709551616.0);
+	CHECK(Json::OnDemandDocument(std::string_view("18446744073709551616")).root().getDouble() == 18446744073709551616.0);
+
+	// Numbers outside the JSON grammar
+	for (const char* number : { "01", "-01", "00", "1.", "1.e5", ".5", "-", "-.5", "1e", "1e+", "1E-", "+1", "0x10", "1.2.3", "--1", "1e5.5", "Infinity", "NaN" }) {
+		CHECK(indexedRejects(number));
+		CHECK(tapeRejects(number));
+		CHECK(indexedRejects(std::string("[") + number + "]"));
+		CHECK(tapeRejects(std::string("{\"n\":") + number + "}"));
+		// The strict parsers validate number tokens but trust the structure, "0x10" is the token "0"
+		if (std::string_view(number) == "0x10") continue;
+		CHECK(strictRejects(number));
+		CHECK(strictRejects(std::string("[") + number + "]"));
+	}
+
+	// The lenient parsers take a '+' in front of a number, but only one and not before a '-'
+	{
+		std::istringstream stream("[+1,+1.5,+2e+2]");
+		CHECK(Value::parse(std::string_view("[+1,+1.5,+2e+2]"))[0] == Value::parseStrict("[1,1.5,2e+2]"));
+		CHECK(Value::parse(stream)[0] == Value::parseStrict("[1,1.5,2e+2]"));
+		CHECK(Json::OnDemandDocument(std::string_view("+7")).root().getInt64() == 7);
+		for (const char* number : { "+-1", "++1", "-+1", "+" }) {
+			CHECK(Test::throws([&] { Value::parse(std::string_view(number)); }));
+			CHECK(Test::throws([&] { Json::OnDemandDocument(std::string_view(number)).root().getDouble(); }));
+		}
+	}
+
+	// Empty documents and malformed structure
+	for (const char* text : { "", " ", "\t\r\n ", "[", "]", "{", "}", "[1,]", "[,1]", "[1 2]", "{\"a\":1,}", "{\"a\" 1}",
+		"{\"a\":}", "{1:2}", "{\"a\":1 \"b\":2}", "[1]]", "[1] 2", "{}{}", "\"abc", "\"a\\x\"", "\"a\\u12\"", "tru", "nul",
+		"True", "nulll", "[true false]", "\"tab\there\"", "/* comment */ 1", "[1] // comment" }) {
+		CHECK(indexedRejects(text));
+		CHECK(tapeRejects(text));
+	}
+
+	// Escapes decode alike in every parser, surrogate pairs to a single 4-byte character, lone surrogates throw
+	{
+		const std::string text = R"(["\ud83c\udf0d \u00e9\u4E16\u0041\n"])";
+		const Value expected = Value::array({ Value("\xF0\x9F\x8C\x8D \xC3\xA9\xE4\xB8\x96" "A\n") });
+		std::istringstream lenient(text), strict(text);
+		CHECK(Value::parseStrict(text) == expected);
+		CHECK(Value::parse(text)[0] == expected);
+		CHECK(Value::parse(lenient)[0] == expected);
+		CHECK(Value::parseStrict(strict) == expected);
+		checkRoundTrip(text);
+
+		for (const char* string : { R"("\ud83c")", R"("\udf0d")", R"("\ud83c\u0041")", R"("\ud83cx")", R"("\ud83c\n")",
+			R"("\udf0d\ud83c")", R"("\u12g4")", R"("\u 123")", R"("\u12")" }) {
+			std::istringstream lenientStream(string), strictStream(string);
+			CHECK(indexedRejects(string));
+			CHECK(tapeRejects(string));
+			CHECK(Test::throws([&] { Value::parseStrict(std::string_view(string)); }));
+			CHECK(Test::throws([&] { Value::parse(std::string_view(string)); }));
+			CHECK(Test::throws([&] { Value::parse(lenientStream); }));
+			CHECK(Test::throws([&] { Value::parseStrict(strictStream); }));
+			std::string buffer;
+			CHECK(Test::throws([&] { Json::OnDemandDocument(std::string_view(string)).root().getString(buffer); }));
+		}
+	}
+
+	// The on-demand cursor reads lazily, errors surface where the value is read
+	{
+		Json::OnDemandDocument empty(std::string_view("   "));
+		CHECK_THROWS(empty.root());
+		const std::string text = R"({"flag":tru,"list":[1,2],"n":1})";
+		Json::OnDemandDocument document(text);
+		CHECK(document["n"].getInt64() == 1);
+		CHECK_THROWS(document["flag"].getBool());
+		CHECK_THROWS(document["missing"]);
+		CHECK_THROWS(document["list"][2]);
+		std::string buffer;
+		CHECK_THROWS(document["list"][0].getString(buffer));
+
+		// Escaped strings decode into the caller's buffer, escaped keys into the iterator
+		const std::string escaped = R"({"a\tb":"x\ny","plain":"z"})";
+		Json::OnDemandDocument strings(escaped);
+		std::string first, second;
+		const std::string_view decoded = strings["a\tb"].getString(first);
+		CHECK(decoded == "x\ny" && decoded.data() == first.data());
+		CHECK(strings["a\tb"].getString(second) == "x\ny");
+		const std::string_view plain = strings["plain"].getString(first);
+		CHECK(plain == "z" && plain.data() == escaped.data() + escaped.find('z'));
+		std::vector<std::string> keys;
+		for (const auto& [key, value] : strings.root().getObject()) keys.emplace_back(key);
+		CHECK(keys == std::vector<std::string>({ "a\tb", "plain" }));
+	}
+
+	return Test::result();
+}
\ No newline at end of file
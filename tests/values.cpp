@@ -0,0 +1,287 @@
+#include "JsonParser/Value.h"
+#include "JsonParser/Document.h"
+#include "Check.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Copy-on-write sharing, what the const accessors may and may not change, and packed and columnar arrays
+
+using Json::Value;
+
+// Keys cannot be changed through iterators, find or try_emplace, which would corrupt the index or the shape
+static_assert(!std::is_assignable_v<decltype((std::declval<Value::Object&>().begin()->first)), Json::String>);
+static_assert(!std::is_assignable_v<decltype((std::declval<Value::Object&>().find("key")->first)), Json::String>);
+static_assert(!std::is_assignable_v<decltype((std::declval<Value::Object&>().try_emplace(std::string_view("key")).first->first)), Json::String>);
+static_assert(std::is_assignable_v<decltype((std::declval<Value::Object&>().begin()->second)), Value>);
+
+// Counts what is allocated from it, on the heap, and fails once allocations reaches limit
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+	size_t allocations = 0;
+	size_t deallocations = 0;
+	size_t limit = SIZE_MAX;
+
+private:
+	void* do_allocate(size_t bytes, size_t alignment) override {
+		if (allocations >= limit) throw std::bad_alloc();
+		++allocations;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+	void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+		++deallocations;
+		std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+	}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+int main() {
+	// The mutable asString hands out a std::string the value owns, copies of it hold the characters again
+	{
+		Value text("short");
+		text.asString() += " and now longer than the inline capacity";
+		CHECK(text.asStringView() == "short and now longer than the inline capacity");
+		const Value copy = text;
+		CHECK(copy == text);
+		CHECK(copy.asString() == text.asStringView());
+		CHECK(Value::parseStrict(text.stringify()) == copy);
+
+		// Boxed strings never come from the Value's resource and are freed with the Value
+		CountingResource resource;
+		{
+			Value root = Value::parseStrict(R"({"name":"a string longer than the inline capacity","short":"s"})", &resource);
+			const size_t allocations = resource.allocations;
+			root["name"].asString() += "!";
+			root["short"].asString() += "!";
+			CHECK(resource.allocations == allocations);
+			CHECK(root["name"].asStringView() == "a string longer than the inline capacity!");
+			root["short"] = Value(int64_t(1));
+		}
+		CHECK(resource.allocations == resource.deallocations);
+	}
+
+	// Moving between containers of different resources keeps the target's resource, and a failed allocation leaves
+	// the target as it was
+	{
+		CountingResource resource;
+		{
+			Value::Array array(&resource);
+			array.push_back(Value(int64_t(1)));
+			Value::Array source{ Value(int64_t(2)), Value(int64_t(3)) };
+			resource.limit = resource.allocations;
+			CHECK_THROWS(array = std::move(source));
+			CHECK(array.size() == 1 && array[0].asInteger() == 1 && source.size() == 2);
+			resource.limit = SIZE_MAX;
+			array = std::move(source);
+			CHECK(array.resource() == &resource && array.size() == 2 && array[1].asInteger() == 3 && source.empty());
+
+			Value::Object object(&resource);
+			object.try_emplace(std::string_view("a"), Value(int64_t(1)));
+			Value::Object members;
+			members.try_emplace(std::string_view("b"), Value(int64_t(2)));
+			resource.limit = resource.allocations;
+			CHECK_THROWS(object = std::move(members));
+			CHECK(object.size() == 1 && object.contains("a") && members.size() == 1);
+			resource.limit = SIZE_MAX;
+			object = std::move(members);
+			CHECK(object.resource() == &resource && object.size() == 1 && object.at("b").asInteger() == 2 && members.empty());
+		}
+		CHECK(resource.allocations == resource.deallocations);
+	}
+
+	// Arrays are packed only on request, the const accessors read a packed array without unpacking it
+	{
+		const std::string text = "[1,2,3,-4]";
+		const Value plain = Value::parseIndexed(text);
+		CHECK(!plain.isIntegerArray());
+		CHECK(plain[3].asInteger() == -4);
+
+		const Json::Document document = Json::Document::parseIndexed(text, { .packed = true });
+		const Value& packed = document.root();
+		CHECK(packed.isIntegerArray());
+		CHECK(packed[0].asInteger() == 1);
+		const Value::Array& values = packed.asArray();
+		CHECK(values.size() == 4 && values[3].asInteger() == -4);
+		CHECK(packed.get<Value::Type::Array>() == &values);
+		CHECK(&packed[3] == &values[3]);
+		int64_t sum = 0;
+		for (const Value& element : packed.asArray()) sum += element.asInteger();
+		CHECK(sum == 2);
+		CHECK(packed.isIntegerArray());
+		CHECK(packed.size() == 4);
+		CHECK(packed.element(3) == Value(int64_t(-4)));
+		CHECK(packed.asIntegerSpan()[1] == 2);
+		CHECK(packed == plain);
+
+		const Json::Document numbers = Json::Document::parseIndexed(std::string_view("[0.5,1.5]"), { .packed = true });
+		CHECK(numbers.root().isNumberArray());
+		CHECK(numbers.root().asNumberSpan()[1] == 1.5);
+
+		// A copy unpacks on mutable access, the document's value stays packed
+		Value copy = packed;
+		copy[0] = Value("one");
+		CHECK(copy[0].asStringView() == "one");
+		CHECK(packed.isIntegerArray() && packed.element(0) == Value(int64_t(1)));
+
+		// The elements read through a const reference follow later changes to the array
+		Value heap = Value::array();
+		heap.pushBackPacked(int64_t(1));
+		CHECK(std::as_const(heap)[0].asInteger() == 1);
+		heap.pushBackPacked(int64_t(2));
+		heap.asIntegerSpan()[0] = 5;
+		CHECK(heap.isIntegerArray());
+		CHECK(std::as_const(heap).asArray().size() == 2 && std::as_const(heap)[0].asInteger() == 5);
+		const Value shared = heap;
+		CHECK(shared[1].asInteger() == 2);
+		heap.pushBackPacked(int64_t(3));
+		CHECK(shared.asArray().size() == 2 && std::as_const(heap).asArray().size() == 3);
+		heap.pushBack(Value("three"));
+		CHECK(!heap.isIntegerArray() && heap[3].asStringView() == "three" && heap[0].asInteger() == 5);
+	}
+
+	// Columnar arrays are read by row with element, by column, or as objects through the const accessors
+	{
+		const std::string text = R"([{"id":1,"name":"one"},{"id":2,"name":"two"},{"id":3,"name":"three"}])";
+		const Json::Document document = Json::Document::parseIndexed(text, { .columnar = true });
+		const Value& rows = document.root();
+		CHECK(rows.isColumnar());
+		CHECK(rows.size() == 3);
+		CHECK(rows[0]["name"].asStringView() == "one");
+		CHECK(rows.asArray().size() == 3 && rows.asArray()[2]["id"].asInteger() == 3);
+		CHECK(rows.element(1) == Value::parseStrict(R"({"id":2,"name":"two"})"));
+		CHECK(rows.column("name").element(2).asStringView() == "three");
+		CHECK(rows.columnKeys().size() == 2);
+		CHECK_THROWS(rows.column("missing"));
+		CHECK(rows.isColumnar());
+		CHECK(rows == Value::parseStrict(text));
+	}
+
+	// Members of a parsed object are changed through structured bindings
+	{
+		Value object = Value::parseIndexed(std::string_view(R"({"a":1,"b":2,"c":3})"));
+		const Value before = object;
+		CHECK(object.asObject().shape() != nullptr);
+		for (auto& [key, value] : object.asObject()) value = Value(value.asInteger() * 10);
+		CHECK(object == Value::parseStrict(R"({"a":10,"b":20,"c":30})"));
+		// Only the values changed, the object still shares its keys through the shape
+		CHECK(object.asObject().shape() != nullptr);
+		for (const auto& [key, value] : std::as_const(object).asObject()) CHECK(object[key] == value);
+		object.asObject().find("b")->second = Value(int64_t(2));
+		CHECK(object["b"].asInteger() == 2);
+		CHECK(before == Value::parseStrict(R"({"a":1,"b":2,"c":3})"));
+		object["d"] = Value(int64_t(40));
+		CHECK(object.size() == 4 && before.size() == 3);
+	}
+
+	// Erasing from an indexed object keeps lookups and the insertion order right through erased slots and rebuilds
+	{
+		Value::Object object;
+		std::vector<std::string> order;
+		for (int i = 0; i < 2000; ++i) {
+			order.push_back("key" + std::to_string(i));
+			object[order.back()] = Value(int64_t(i));
+		}
+		std::mt19937 random(3);
+		for (int round = 0; round < 3000; ++round) {
+			if (random() % 3 && !order.empty()) {
+				const size_t victim = random() % order.size();
+				CHECK(object.erase(order[victim]) == 1);
+				CHECK(object.erase(order[victim]) == 0);
+				order.erase(order.begin() + victim);
+			}
+			else {
+				order.push_back("added" + std::to_string(round));
+				object[order.back()] = Value(int64_t(-round));
+			}
+		}
+		CHECK(object.size() == order.size());
+		size_t index = 0;
+		bool inOrder = true;
+		for (const auto& [key, value] : object) inOrder &= key.view() == order[index++];
+		CHECK(inOrder);
+		bool found = true;
+		for (const std::string& key : order) found &= object.contains(key) && object.find(key)->first.view() == key;
+		CHECK(found);
+		CHECK(!object.contains("key0") || std::find(order.begin(), order.end(), "key0") != order.end());
+	}
+
+	// Copies share their container until one of them is changed
+	{
+		const Value original = Value::parseStrict(R"({"list":[1,2,3],"inner":{"a":"b"}})");
+		Value copy = original;
+		CHECK(&std::as_const(copy).asObject() == &original.asObject());
+		CHECK(&copy.asObject() != &original.asObject());
+		CHECK(copy == original);
+
+		copy["list"][0] = Value(int64_t(10));
+		CHECK(&std::as_const(copy).asObject() != &original.asObject());
+		CHECK(original["list"][0].asInteger() == 1);
+		CHECK(copy["list"][0].asInteger() == 10);
+		CHECK(copy["inner"] == original["inner"]);
+
+		Value array = Value::array({ Value(int64_t(1)), Value("two") });
+		Value shared = array;
+		shared.pushBack(Value(true));
+		CHECK(array.size() == 2 && shared.size() == 3);
+	}
+
+	// Const access leaves a shared value shared and a missing key missing
+	{
+		const Value original = Value::parseStrict(R"({"list":[1,2],"inner":{"a":1}})");
+		const Value copy = original;
+		const Value::Array* list = copy["list"].get<Value::Type::Array>();
+		CHECK(list == original["list"].get<Value::Type::Array>());
+		CHECK(copy.get<Value::Type::Object>() == original.get<Value::Type::Object>());
+		CHECK(copy["missing"].isNull());
+		CHECK(copy.size() == 2);
+		CHECK(!copy.asObject().contains("missing"));
+		CHECK(copy["inner"]["a"].asInteger() == 1);
+	}
+
+	// Threads read one shared value through the const accessors without synchronizing
+	{
+		Value shared = Value::parseStrict(R"({"items":[1,2,3,4],"name":"shared"})");
+		const Value& view = shared;
+		std::vector<std::thread> threads;
+		std::vector<int64_t> sums(4, 0);
+		for (size_t t = 0; t < sums.size(); ++t) {
+			threads.emplace_back([&view, &sums, t] {
+				for (int i = 0; i < 10000; ++i) {
+					const Value copy = view;
+					for (const Value& item : copy["items"].asArray()) sums[t] += item.asInteger();
+					if (copy["name"].asStringView() != "shared" || !copy["missing"].isNull()) sums[t] = -1;
+				}
+			});
+		}
+		for (auto& thread : threads) thread.join();
+		for (int64_t sum : sums) CHECK(sum == 100000);
+	}
+
+	// Threads reading one packed array as Values all get the same elements, whichever built them
+	{
+		const Json::Document document = Json::Document::parseIndexed(std::string_view("[[1,2,3,4],[0.5,1.5]]"), { .packed = true });
+		const Value& integers = document.root()[0];
+		std::vector<std::thread> threads;
+		std::vector<const Value::Array*> arrays(4, nullptr);
+		std::vector<int64_t> sums(4, 0);
+		for (size_t t = 0; t < arrays.size(); ++t) {
+			threads.emplace_back([&integers, &arrays, &sums, t] {
+				arrays[t] = &integers.asArray();
+				for (const Value& item : *arrays[t]) sums[t] += item.asInteger();
+			});
+		}
+		for (auto& thread : threads) thread.join();
+		for (size_t t = 0; t < arrays.size(); ++t) CHECK(arrays[t] == arrays[0] && sums[t] == 10);
+		CHECK(integers.isIntegerArray() && document.root()[1][1].asNumber() == 1.5);
+	}
+
+	return Test::result();
+}
\ No newline at end of file
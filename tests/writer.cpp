@@ -0,0 +1,103 @@
+#include "JsonParser/Value.h"
+#include "JsonParser/Writer.h"
+#include "Check.h"
+#include <cstdint>
+#include <limits>
+#include <string>
+
+// The Writer lays its tokens out like the Serializer and throws for calls that would not make JSON
+
+using Json::Value;
+using Writer = Json::Writer<std::string>;
+
+static void writeSample(Writer& writer) {
+	writer.startObject()
+		.key("id").value(42)
+		.key("name").value("a \"quoted\"\n name")
+		.key("tags").startArray().value("a").value(1.5).value(true).null().endArray()
+		.key("empty").startObject().endObject()
+		.key("nested").startArray().startArray().endArray().startObject().key("k").value(std::numeric_limits<uint64_t>::max()).endObject().endArray()
+		.endObject();
+}
+
+template<typename F>
+static bool misuseThrows(F write) {
+	std::string output;
+	Writer writer(output);
+	return Test::throws([&] { write(writer); });
+}
+
+int main() {
+	// Compact and indented output, read back to the same value
+	{
+		const Value expected = Value::parseStrict(R"({"id":42,"name":"a \"quoted\"\n name","tags":["a",1.5,true,null],"empty":{},
+			"nested":[[],{"k":18446744073709551615}]})");
+
+		std::string compact;
+		Writer writer(compact);
+		CHECK(!writer.complete());
+		writeSample(writer);
+		CHECK(writer.complete());
+		CHECK(compact == R"({"id":42,"name":"a \"quoted\"\n name","tags":["a",1.5,true,null],"empty":{},"nested":[[],{"k":18446744073709551615}]})");
+		CHECK(Value::parseStrict(compact) == expected);
+
+		std::string indented;
+		Writer indentedWriter(indented, 2);
+		writeSample(indentedWriter);
+		CHECK(indentedWriter.complete());
+		CHECK(Value::parseStrict(indented) == expected);
+		CHECK(indented.find("\n  \"id\": 42,\n") != std::string::npos);
+		CHECK(indented.find("\"empty\": {},") != std::string::npos);
+
+		std::string root;
+		Writer(root).value(std::numeric_limits<int64_t>::min());
+		CHECK(root == "-9223372036854775808");
+
+		std::string raw;
+		Writer(raw).startArray().rawValue(R"({"pre":"written"})").value(1.0).endArray();
+		CHECK(raw == R"([{"pre":"written"},1.0])");
+	}
+
+	// Calls that would not make JSON
+	{
+		CHECK(misuseThrows([](Writer& writer) { writer.key("outside"); }));
+		CHECK(misuseThrows([](Writer& writer) { writer.startArray().key("in an array"); }));
+		CHECK(misuseThrows([](Writer& writer) { writer.startObject().value(1); }));
+		CHECK(misuseThrows([](Writer& writer) { writer.startObject().key("a").value(1).value(2); }));
+		CHECK(misuseThrows([](Writer& writer) { writer.startObject().key("a").key("b"); }));
+		CHECK(misuseThrows([](Writer& writer) { writer.startObject().key("a").endObject(); }));
+		CHECK(misuseThrows([](Writer& writer) { writer.startObject().endArray(); }));
+		CHECK(misuseThrows([](Writer& writer) { writer.startArray().endObject(); }));
+		CHECK(misuseThrows([](Writer& writer) { writer.endArray(); }));
+		CHECK(misuseThrows([](Writer& writer) { writer.value(1).value(2); }));
+		CHECK(misuseThrows([](Writer& writer) { writer.startArray().endArray().startArray(); }));
+		CHECK(!misuseThrows([](Writer& writer) { writer.startObject().key("a").startArray().endArray().endObject(); }));
+
+		// The open containers are tracked a bit each, across several words and up to maxDepth
+		std::string deep;
+		Writer deepWriter(deep);
+		for (size_t level = 0; level < 200; ++level) {
+			if (level % 3) deepWriter.startArray();
+			else deepWriter.startObject().key("k");
+		}
+		CHECK(Test::throws([&] { deepWriter.key("in an array"); }));
+		CHECK(Test::throws([&] { deepWriter.endObject(); }));
+		for (size_t level = 200; level-- > 0;) {
+			if (level % 3) deepWriter.endArray();
+			else deepWriter.endObject();
+		}
+		CHECK(deepWriter.complete());
+		CHECK(Value::parseStrict(deep).isObject());
+		CHECK(!misuseThrows([](Writer& writer) { for (size_t i = 0; i < Writer::maxDepth; ++i) writer.startArray(); }));
+		CHECK(misuseThrows([](Writer& writer) { for (size_t i = 0; i <= Writer::maxDepth; ++i) writer.startArray(); }));
+
+		std::string output;
+		Writer writer(output);
+		writer.startObject().key("a").value(1);
+		CHECK(!writer.complete());
+		writer.endObject();
+		CHECK(writer.complete());
+	}
+
+	return Test::result();
+}
\ No newline at end of file